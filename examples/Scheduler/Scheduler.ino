@@ -0,0 +1,31 @@
+#include <UnixRTC.h>
+#include <UnixRTCScheduler.h>
+
+UnixRTC rtc;
+UnixRTCScheduler scheduler(rtc);
+
+const uint8_t intPin = 2;  //INT/SQW pin of the RTC
+
+void readSensor(uint64_t deadline, void* context) {
+  Serial.println("Reading sensor");
+}
+
+void upload(uint64_t deadline, void* context) {
+  Serial.println("Uploading");
+}
+
+void setup() {
+  Serial.begin(115200);
+  rtc.begin();
+  Serial.println("RTC Initialized");
+  pinMode(intPin, INPUT_PULLUP);  //INT is open drain, active low
+  scheduler.begin();              //INT mode, Alarm 1 interrupt enabled
+  scheduler.scheduleIn(10, readSensor, nullptr, 60);  //Every minute, starting in 10 seconds
+  scheduler.scheduleIn(30, upload, nullptr, 3600);    //Every hour, starting in 30 seconds
+}
+
+void loop() {
+  if (digitalRead(intPin) == LOW) {  //Alarm 1 fired, the MCU could sleep until then
+    scheduler.service();
+  }
+}
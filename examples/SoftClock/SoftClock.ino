@@ -0,0 +1,31 @@
+#include <UnixRTC.h>
+
+UnixRTC rtc;
+
+const uint8_t sqwPin = 2;  //INT/SQW pin of the RTC, must support interrupts
+
+void onSQW() {
+  rtc.sqwEdge();
+}
+
+void setup() {
+  Serial.begin(115200);
+  rtc.begin();
+  Serial.println("RTC Initialized");
+  pinMode(sqwPin, INPUT_PULLUP);  //SQW is open drain
+  attachInterrupt(digitalPinToInterrupt(sqwPin), onSQW, FALLING);
+  if (rtc.beginSoftClock() == RTC_SOFT_SQW) {  //Falls back to polling the RTC once per second if no edges arrive
+    Serial.println("Software clock disciplined by SQW");
+  } else {
+    Serial.println("No SQW edges, software clock polls the RTC");
+  }
+}
+
+void loop() {
+  uint64_t unixMs = rtc.getTimeMs();  //No I2C traffic
+  char timestamp[RTC_ISO8601_LENGTH];
+  UnixRTC::formatISO8601Ms(unixMs, timestamp, sizeof(timestamp));
+  Serial.print("Current time: ");
+  Serial.println(timestamp);
+  delay(250);
+}
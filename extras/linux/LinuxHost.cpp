@@ -0,0 +1,44 @@
+/*
+  Arduino runtime for running UnixRTC on Linux with UnixRTCLinuxI2C: real time from CLOCK_MONOTONIC,
+  no pins (bus recovery and the alarm and SQW interrupts are not available)
+*/
+
+#include "Arduino.h"
+
+#include <sched.h>
+#include <time.h>
+
+static uint64_t monotonicMicros() {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
+uint32_t millis() {
+  return monotonicMicros() / 1000;
+}
+uint32_t micros() {
+  return monotonicMicros();
+}
+void delay(uint32_t ms) {
+  delayMicroseconds(ms * 1000);
+}
+void delayMicroseconds(uint32_t us) {
+  struct timespec wait = { (time_t)(us / 1000000), (long)(us % 1000000) * 1000 };
+  while (nanosleep(&wait, &wait)) {}
+}
+void yield() {
+  sched_yield();
+}
+void noInterrupts() {}
+void interrupts() {}
+void pinMode(uint8_t, uint8_t) {}
+void digitalWrite(uint8_t, uint8_t) {}
+int digitalRead(uint8_t) {
+  return HIGH;
+}
+int digitalPinToInterrupt(uint8_t) {
+  return -1;
+}
+void attachInterrupt(int, void (*)(), int) {}
+void detachInterrupt(int) {}
@@ -0,0 +1,74 @@
+#include "UnixRTCLinuxI2C.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
+
+#define MAX_WRITE 64  //Longest head + data of a write, joined into one message
+
+UnixRTCLinuxI2C::UnixRTCLinuxI2C(const char* path)
+  : path(path), fd(-1), error(0), timeout(0) {}
+
+UnixRTCLinuxI2C::~UnixRTCLinuxI2C() {
+  end();
+}
+
+void UnixRTCLinuxI2C::begin() {
+  if (fd >= 0) return;
+  fd = open(path, O_RDWR | O_CLOEXEC);
+  if (fd < 0) {
+    error = errno;
+    return;
+  }
+  ioctl(fd, I2C_RETRIES, 0);  //Retries are UnixRTC's, within its time budget
+  if (timeout) setTimeout(timeout);
+}
+
+void UnixRTCLinuxI2C::end() {
+  if (fd >= 0) close(fd);
+  fd = -1;
+}
+
+void UnixRTCLinuxI2C::setTimeout(uint32_t us) {
+  timeout = us;
+  if (fd >= 0 && us) ioctl(fd, I2C_TIMEOUT, (unsigned long)((us + 9999) / 10000));
+}
+
+uint8_t UnixRTCLinuxI2C::transfer(uint8_t address, const uint8_t* head, uint8_t headLength, uint8_t* data, uint8_t length, bool read) {
+  if (fd < 0) return RTC_ERR_BUS;
+  uint8_t buffer[MAX_WRITE];
+  struct i2c_msg messages[2];
+  uint8_t count = 0;
+  if (read) {
+    if (headLength) messages[count++] = { address, 0, headLength, (uint8_t*)head };
+    messages[count++] = { address, I2C_M_RD, length, data };
+  } else {
+    if (headLength + length > MAX_WRITE) return RTC_ERR_TOO_LONG;
+    memcpy(buffer, head, headLength);
+    memcpy(buffer + headLength, data, length);
+    messages[count++] = { address, 0, (uint16_t)(headLength + length), buffer };
+  }
+  struct i2c_rdwr_ioctl_data transaction = { messages, count };
+  if (ioctl(fd, I2C_RDWR, &transaction) >= 0) return RTC_OK;
+  error = errno;
+  switch (error) {
+    case ENXIO:
+    case EREMOTEIO:
+      return RTC_ERR_NACK_ADDRESS;  //Most adapters don't say which byte was not acknowledged
+    case ETIMEDOUT:
+      return RTC_ERR_TIMEOUT;
+    default:
+      return RTC_ERR_BUS;
+  }
+}
+
+bool UnixRTCLinuxI2C::isOpen() {
+  return fd >= 0;
+}
+
+int UnixRTCLinuxI2C::lastErrno() {
+  return error;
+}
@@ -0,0 +1,32 @@
+/*
+  UnixRTC transport for Linux /dev/i2c-N (Raspberry Pi, gateways...), see UnixRTCTransport.h
+  - Part of the UnixRTC library: https://github.com/cornflowerenderman/UnixRTClib (MIT License, see UnixRTC.h)
+
+  A read is one I2C_RDWR ioctl with the register pointer write and the read joined by a repeated start,
+  so no other bus master or process can move the pointer in between. The kernel's own retries are turned off,
+  UnixRTC's setRetries() and setTimeBudget() apply instead.
+*/
+
+#ifndef UnixRTCLinuxI2C_h
+#define UnixRTCLinuxI2C_h
+
+#include "UnixRTCTransport.h"
+
+class UnixRTCLinuxI2C {  //One /dev/i2c-N adapter, shareable by any number of devices
+public:
+  UnixRTCLinuxI2C(const char* path = "/dev/i2c-1");  //The 40 pin header bus on a Raspberry Pi
+  ~UnixRTCLinuxI2C();
+  void begin();                  //Opens the adapter, see isOpen()
+  void end();                    //Closes it
+  void setTimeout(uint32_t us);  //Adapter timeout, in the kernel's 10ms steps (0 leaves the adapter default)
+  uint8_t transfer(uint8_t address, const uint8_t* head, uint8_t headLength, uint8_t* data, uint8_t length, bool read);
+  bool isOpen();
+  int lastErrno();               //errno of the last failed ioctl()
+private:
+  const char* path;
+  int fd;
+  int error;
+  uint32_t timeout;
+};
+
+#endif
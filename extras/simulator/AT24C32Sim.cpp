@@ -0,0 +1,45 @@
+#include "AT24C32Sim.h"
+
+AT24C32Sim::AT24C32Sim(TwoWire& bus, uint8_t address)
+  : writeMicros(5000), writeCycles(0), bus(bus), address(address), pointer(0), busyLeft(0) {
+  memset(memory, 0xFF, sizeof(memory));
+  memset(pageWrites, 0, sizeof(pageWrites));
+  bus.attach(address, this);
+}
+
+AT24C32Sim::~AT24C32Sim() {
+  bus.detach(address);
+}
+
+bool AT24C32Sim::i2cWrite(const uint8_t* data, uint8_t length) {
+  if (busyLeft) return false;  //No acknowledge during a write cycle
+  if (length < 2) return true;
+  pointer = ((data[0] << 8) | data[1]) & 0xFFF;
+  if (length == 2) return true;  //Address only, sets up a read
+  uint16_t page = pointer & 0xFE0;
+  for (uint8_t i = 2; i < length; i++) {
+    memory[pointer] = data[i];
+    pointer = page | ((pointer + 1) & 0x1F);  //Rolls over within the page
+  }
+  pageWrites[page >> 5]++;
+  writeCycles++;
+  busyLeft = writeMicros;
+  return true;
+}
+
+uint8_t AT24C32Sim::i2cRead(uint8_t* data, uint8_t length) {
+  if (busyLeft) return 0;
+  for (uint8_t i = 0; i < length; i++) {
+    data[i] = memory[pointer];
+    pointer = (pointer + 1) & 0xFFF;
+  }
+  return length;
+}
+
+void AT24C32Sim::advance(uint32_t us) {
+  busyLeft = busyLeft > us ? busyLeft - us : 0;
+}
+
+bool AT24C32Sim::busy() {
+  return busyLeft;
+}
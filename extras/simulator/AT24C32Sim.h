@@ -0,0 +1,33 @@
+/*
+  AT24C32 model for the host simulator: 4096 bytes with a 12 bit address counter, 32 byte page writes
+  that wrap within the page, sequential reads across pages, and a write cycle during which the chip
+  NAKs everything (so ACK polling works). Counts write cycles per page for wear checks.
+*/
+
+#ifndef AT24C32Sim_h
+#define AT24C32Sim_h
+
+#include "SimHost.h"
+#include "Wire.h"
+
+class AT24C32Sim : public SimI2CDevice, public SimClocked {  //I2C EEPROM found on most DS3231 modules
+public:
+  AT24C32Sim(TwoWire& bus = Wire, uint8_t address = 0x57);
+  ~AT24C32Sim();
+  bool i2cWrite(const uint8_t* data, uint8_t length);
+  uint8_t i2cRead(uint8_t* data, uint8_t length);
+  void advance(uint32_t us);
+
+  bool busy();                   //Write cycle running
+  uint32_t writeMicros;          //Length of a write cycle
+  uint8_t memory[4096];          //Contents, erased to 0xFF
+  uint32_t pageWrites[128];      //Write cycles per page
+  uint32_t writeCycles;          //Write cycles in total
+private:
+  TwoWire& bus;
+  uint8_t address;
+  uint16_t pointer;
+  uint32_t busyLeft;
+};
+
+#endif
@@ -0,0 +1,84 @@
+/*
+  Minimal Arduino core for building UnixRTC on a host, see SimHost.h
+*/
+
+#ifndef Arduino_h
+#define Arduino_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
+#include <stdio.h>
+
+#define PROGMEM
+#define pgm_read_byte(addr) (*(const uint8_t*)(addr))
+#define pgm_read_word(addr) (*(const uint16_t*)(addr))
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define FALLING 2
+#define RISING 3
+#define CHANGE 1
+#define SDA 20
+#define SCL 21
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void yield();
+void noInterrupts();
+void interrupts();
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+int digitalPinToInterrupt(uint8_t pin);
+void attachInterrupt(int interrupt, void (*isr)(), int mode);
+void detachInterrupt(int interrupt);
+
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  size_t write(const uint8_t* buf, size_t len) {
+    size_t n = 0;
+    while (len--) n += write(*buf++);
+    return n;
+  }
+  size_t write(const char* str) { return write((const uint8_t*)str, strlen(str)); }
+  size_t print(const char* str) { return write(str); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(unsigned long n, int base = 10) {
+    char buf[24];
+    char* p = buf + sizeof(buf) - 1;
+    *p = 0;
+    do {
+      *--p = "0123456789ABCDEF"[n % base];
+      n /= base;
+    } while (n);
+    return write(p);
+  }
+  size_t print(long n, int base = 10) {
+    if (n < 0) return print('-') + print((unsigned long)-n, base);
+    return print((unsigned long)n, base);
+  }
+  size_t print(unsigned int n, int base = 10) { return print((unsigned long)n, base); }
+  size_t print(int n, int base = 10) { return print((long)n, base); }
+  size_t print(double d, int digits = 2) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.*f", digits, d);
+    return write(buf);
+  }
+  size_t println() { return write("\r\n"); }
+  template <typename T> size_t println(T v) { return print(v) + println(); }
+};
+#include <stdio.h>
+
+#endif
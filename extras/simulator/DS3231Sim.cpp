@@ -0,0 +1,228 @@
+#include "DS3231Sim.h"
+
+static uint8_t toDec(uint8_t bcd) {
+  return (bcd & 0xF) + (bcd >> 4) * 10;
+}
+static uint8_t toBcd(uint8_t dec) {
+  return ((dec / 10) << 4) | (dec % 10);
+}
+static uint8_t hour24(uint8_t reg) {  //Hour register (12 or 24h) to 0-23
+  if (!(reg & 0x40)) return toDec(reg & 0x3F);
+  uint8_t h = toDec(reg & 0x1F) % 12;
+  return (reg & 0x20) ? h + 12 : h;
+}
+static uint8_t hourReg(uint8_t hour, bool mode12) {  //0-23 to an hour register in the given mode
+  if (!mode12) return toBcd(hour);
+  bool pm = hour >= 12;
+  uint8_t h = hour % 12;
+  if (h == 0) h = 12;
+  return toBcd(h) | 0x40 | (pm ? 0x20 : 0);
+}
+
+DS3231Sim::DS3231Sim(TwoWire& bus, uint8_t address)
+  : conversionMicros(125000), driftPPM(0), agingPPM(0.1f), bus(bus), address(address), pointer(0), countdown(0), aging(0), driftCarry(0), conversionLeft(0), autoConvert(0), vcc(true), running(true), nextTemp(25 * 4), intPin(-1) {
+  memset(regs, 0, sizeof(regs));
+  regs[3] = 1;
+  regs[4] = 1;
+  regs[5] = 1;
+  regs[0x0E] = 0x1C;  //Power on defaults: INTCN, RS2, RS1
+  regs[0x0F] = 0x88;  //OSF and EN32kHz
+  regs[0x11] = 25;
+  bus.attach(address, this);
+}
+
+DS3231Sim::~DS3231Sim() {
+  bus.detach(address);
+}
+
+bool DS3231Sim::i2cWrite(const uint8_t* data, uint8_t length) {
+  if (!length) return true;
+  pointer = data[0];
+  if (pointer > 0x12) return false;
+  for (uint8_t i = 1; i < length; i++) {
+    uint8_t value = data[i];
+    if (pointer == 0x00) countdown = 0;  //Writing seconds resets the countdown chain
+    if (pointer == 0x0E) {
+      bool conv = value & 0x20;
+      value &= 0xDF;
+      value |= regs[0x0E] & 0x20;
+      regs[0x0E] = value;
+      if (conv && !(regs[0x0F] & 0x04) && !(regs[0x0E] & 0x20)) startConversion();
+    } else if (pointer == 0x0F) {
+      uint8_t flags = regs[0x0F] & 0x83 & value;  //OSF, A1F and A2F can only be cleared
+      regs[0x0F] = (regs[0x0F] & 0x04) | (value & 0x08) | flags;
+    } else if (pointer < 0x11) {
+      regs[pointer] = value;
+    }
+    pointer = (pointer + 1) % 0x13;
+  }
+  updatePin();
+  return true;
+}
+
+uint8_t DS3231Sim::i2cRead(uint8_t* data, uint8_t length) {
+  for (uint8_t i = 0; i < length; i++) {
+    data[i] = regs[pointer];
+    pointer = (pointer + 1) % 0x13;
+  }
+  return length;
+}
+
+void DS3231Sim::setVcc(bool present) {
+  vcc = present;
+}
+
+void DS3231Sim::powerLoss() {
+  running = false;
+  regs[0x0F] |= 0x80;
+}
+
+void DS3231Sim::setTemperature(float degrees) {
+  nextTemp = (int16_t)lround(degrees * 4);
+}
+
+void DS3231Sim::connectIntPin(uint8_t pin) {
+  intPin = pin;
+  simSetPin(pin, HIGH);
+  updatePin();
+}
+
+uint32_t DS3231Sim::subSecondMicros() {
+  return countdown;
+}
+
+void DS3231Sim::startConversion() {
+  regs[0x0E] |= 0x20;
+  regs[0x0F] |= 0x04;
+  conversionLeft = conversionMicros;
+}
+
+void DS3231Sim::advance(uint32_t us) {
+  if (conversionLeft) {
+    if (conversionLeft <= us) {
+      conversionLeft = 0;
+      aging = regs[0x10];  //The offset reaches the capacitor array with a conversion
+      regs[0x11] = (uint8_t)(nextTemp >> 2);
+      regs[0x12] = (nextTemp & 3) << 6;
+      regs[0x0E] &= 0xDF;
+      regs[0x0F] &= 0xFB;
+    } else {
+      conversionLeft -= us;
+    }
+  }
+  if (!vcc && (regs[0x0E] & 0x80)) {  //EOSC stops the oscillator on battery
+    if (running) regs[0x0F] |= 0x80;
+    running = false;
+  } else if (!running && vcc) {
+    running = true;
+  }
+  if (!running) return;
+  bool wasHigh = countdown < 500000;
+  driftCarry += us * (driftPPM - aging * agingPPM) * 1e-6;
+  int32_t whole = (int32_t)floor(driftCarry);
+  driftCarry -= whole;
+  countdown += us + whole;
+  while (countdown >= 1000000) {
+    countdown -= 1000000;
+    tickSecond();
+  }
+  if (wasHigh != (countdown < 500000)) updatePin();
+}
+
+void DS3231Sim::tickSecond() {
+  static const uint8_t daysInMonth[12] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+  uint8_t second = toDec(regs[0] & 0x7F) + 1;
+  if (second < 60) {
+    regs[0] = toBcd(second);
+  } else {
+    regs[0] = 0;
+    uint8_t minute = toDec(regs[1] & 0x7F) + 1;
+    if (minute < 60) {
+      regs[1] = toBcd(minute);
+    } else {
+      regs[1] = 0;
+      bool mode12 = regs[2] & 0x40;
+      uint8_t hour = hour24(regs[2]) + 1;
+      if (hour < 24) {
+        regs[2] = hourReg(hour, mode12);
+      } else {
+        regs[2] = hourReg(0, mode12);
+        regs[3] = regs[3] % 7 + 1;
+        uint8_t year = toDec(regs[6]);
+        uint8_t month = toDec(regs[5] & 0x1F);
+        uint8_t day = toDec(regs[4] & 0x3F) + 1;
+        uint8_t length = daysInMonth[month - 1];
+        if (month == 2 && (year % 4) == 0) length = 29;  //Century ignored: the Y2100 leap year bug
+        if (day <= length) {
+          regs[4] = toBcd(day);
+        } else {
+          regs[4] = 1;
+          uint8_t century = regs[5] & 0x80;
+          if (++month > 12) {
+            month = 1;
+            if (++year > 99) {
+              year = 0;
+              century ^= 0x80;
+            }
+            regs[6] = toBcd(year);
+          }
+          regs[5] = toBcd(month) | century;
+        }
+      }
+    }
+  }
+  if (++autoConvert >= 64) {
+    autoConvert = 0;
+    if (!(regs[0x0F] & 0x04)) {
+      regs[0x0F] |= 0x04;
+      conversionLeft = conversionMicros;
+    }
+  }
+  checkAlarms();
+  updatePin();
+}
+
+void DS3231Sim::checkAlarms() {
+  uint8_t a1 = regs[0x0A];
+  bool mask1[4] = { (bool)(regs[7] & 0x80), (bool)(regs[8] & 0x80), (bool)(regs[9] & 0x80), (bool)(a1 & 0x80) };
+  bool match = true;
+  if (!mask1[0] && toDec(regs[7] & 0x7F) != toDec(regs[0])) match = false;
+  if (!mask1[1] && toDec(regs[8] & 0x7F) != toDec(regs[1])) match = false;
+  if (!mask1[2] && hour24(regs[9] & 0x7F) != hour24(regs[2])) match = false;
+  if (!mask1[3]) {
+    if (a1 & 0x40) {
+      if ((a1 & 0x0F) != regs[3]) match = false;
+    } else if (toDec(a1 & 0x3F) != toDec(regs[4])) {
+      match = false;
+    }
+  }
+  if (match) regs[0x0F] |= 0x01;
+  if (regs[0] == 0) {
+    uint8_t a2 = regs[0x0D];
+    match = true;
+    if (!(regs[0x0B] & 0x80) && toDec(regs[0x0B] & 0x7F) != toDec(regs[1])) match = false;
+    if (!(regs[0x0C] & 0x80) && hour24(regs[0x0C] & 0x7F) != hour24(regs[2])) match = false;
+    if (!(a2 & 0x80)) {
+      if (a2 & 0x40) {
+        if ((a2 & 0x0F) != regs[3]) match = false;
+      } else if (toDec(a2 & 0x3F) != toDec(regs[4])) {
+        match = false;
+      }
+    }
+    if (match) regs[0x0F] |= 0x02;
+  }
+}
+
+void DS3231Sim::updatePin() {
+  if (intPin < 0) return;
+  uint8_t level;
+  if (regs[0x0E] & 0x04) {  //INTCN: alarm interrupts, active low
+    bool active = ((regs[0x0F] & 0x01) && (regs[0x0E] & 0x01)) || ((regs[0x0F] & 0x02) && (regs[0x0E] & 0x02));
+    level = active ? LOW : HIGH;
+  } else if (((regs[0x0E] >> 3) & 3) == 0) {  //1Hz square wave, falling edge on the seconds update
+    level = countdown < 500000 ? LOW : HIGH;
+  } else {
+    level = HIGH;  //Faster square waves are not modelled
+  }
+  if (simGetPin(intPin) != level) simSetPin(intPin, level);
+}
@@ -0,0 +1,49 @@
+/*
+  DS3231 model for the host simulator: register map (0x00-0x12) with pointer auto-increment and wrap,
+  time ticking with the Y2100 leap year bug, countdown chain reset on seconds writes, alarm matching
+  (all A1Mx/A2Mx/DY modes), OSF/EOSC behaviour on battery, temperature conversions (CONV/BSY) and INT/SQW.
+*/
+
+#ifndef DS3231Sim_h
+#define DS3231Sim_h
+
+#include "SimHost.h"
+#include "Wire.h"
+
+class DS3231Sim : public SimI2CDevice, public SimClocked {  //Register level model of the DS3231
+public:
+  DS3231Sim(TwoWire& bus = Wire, uint8_t address = 0x68);
+  ~DS3231Sim();
+  bool i2cWrite(const uint8_t* data, uint8_t length);
+  uint8_t i2cRead(uint8_t* data, uint8_t length);
+  void advance(uint32_t us);
+
+  void setVcc(bool present);                     //Removing VCC runs from VBAT, where EOSC stops the oscillator
+  void powerLoss();                              //Total power loss, stops the clock and sets OSF
+  void setTemperature(float degrees);            //Next conversion result
+  void connectIntPin(uint8_t pin);               //INT/SQW pin wired to a simulated input
+  uint32_t subSecondMicros();                    //Position within the current second
+  uint32_t conversionMicros;                     //Length of a temperature conversion
+  float driftPPM;                                //Crystal frequency error at an aging offset of 0 (positive runs fast)
+  float agingPPM;                                //Frequency change per aging offset LSB, applied at the next conversion as on the real chip
+  uint8_t regs[0x13];                            //Register file (0x00-0x12)
+private:
+  TwoWire& bus;
+  uint8_t address;
+  uint8_t pointer;
+  uint32_t countdown;
+  int8_t aging;      //Aging offset in effect since the last conversion
+  double driftCarry;  //Fraction of a microsecond gained or lost so far
+  uint32_t conversionLeft;
+  uint8_t autoConvert;
+  bool vcc;
+  bool running;
+  int16_t nextTemp;
+  int intPin;
+  void tickSecond();
+  void checkAlarms();
+  void updatePin();
+  void startConversion();
+};
+
+#endif
@@ -0,0 +1,283 @@
+#include "SimHost.h"
+
+#include "Wire.h"
+
+static uint64_t nowUs = 0;
+static SimClocked* clocked = 0;
+static uint8_t pinLevels[64];
+static uint8_t pinModes[64];
+static bool pinHeld[64];
+static void (*pinIsr[64])() = { 0 };
+static int pinIsrMode[64];
+static int interruptsDisabled = 0;
+
+SimClocked::SimClocked() : next(clocked) {
+  clocked = this;
+}
+SimClocked::~SimClocked() {
+  for (SimClocked** p = &clocked; *p; p = &(*p)->next) {
+    if (*p == this) {
+      *p = next;
+      break;
+    }
+  }
+}
+
+uint64_t simMicros() {
+  return nowUs;
+}
+
+void simAdvance(uint32_t us) {
+  while (us) {  //Step in 1ms slices so square waves and conversions stay ordered
+    uint32_t step = us > 1000 ? 1000 : us;
+    nowUs += step;
+    us -= step;
+    for (SimClocked* c = clocked; c; c = c->next) c->advance(step);
+  }
+}
+
+void simSetPin(uint8_t pin, uint8_t level) {
+  uint8_t old = pinLevels[pin];
+  pinLevels[pin] = level;
+  if (!pinIsr[pin] || interruptsDisabled || old == level) return;
+  if ((pinIsrMode[pin] == FALLING && !level) || (pinIsrMode[pin] == RISING && level) || pinIsrMode[pin] == CHANGE) pinIsr[pin]();
+}
+
+uint8_t simGetPin(uint8_t pin) {
+  return pinLevels[pin];
+}
+
+void simHoldPin(uint8_t pin, bool held) {
+  pinHeld[pin] = held;
+}
+
+uint32_t millis() {
+  return nowUs / 1000;
+}
+uint32_t micros() {
+  simAdvance(1);  //Reading the clock is never free, keeps busy-wait loops finite
+  return nowUs;
+}
+void delay(uint32_t ms) {
+  while (ms--) simAdvance(1000);
+}
+void delayMicroseconds(uint32_t us) {
+  simAdvance(us);
+}
+void yield() {
+  simAdvance(1);
+}
+void noInterrupts() {
+  interruptsDisabled++;
+}
+void interrupts() {
+  if (interruptsDisabled) interruptsDisabled--;
+}
+void pinMode(uint8_t pin, uint8_t mode) {
+  pinModes[pin] = mode;
+  if (mode == INPUT_PULLUP && !pinLevels[pin]) pinLevels[pin] = HIGH;
+  if (pin == SCL && mode == OUTPUT && !pinLevels[pin]) Wire.sclClock();
+}
+void digitalWrite(uint8_t pin, uint8_t value) {
+  pinLevels[pin] = value;
+}
+int digitalRead(uint8_t pin) {
+  return pinHeld[pin] ? LOW : pinLevels[pin];
+}
+int digitalPinToInterrupt(uint8_t pin) {
+  return pin;
+}
+void attachInterrupt(int interrupt, void (*isr)(), int mode) {
+  pinIsr[interrupt] = isr;
+  pinIsrMode[interrupt] = mode;
+}
+void detachInterrupt(int interrupt) {
+  pinIsr[interrupt] = 0;
+}
+
+TwoWire Wire;
+TwoWire Wire1;
+
+TwoWire::TwoWire()
+  : clock(100000), txAddress(0), txLength(0), transmitting(false), rxLength(0), rxIndex(0), faults(0), faultNak(true), faultMicros(0), corruptReads(0), sdaHeld(0) {
+  memset(devices, 0, sizeof(devices));
+  memset(&stats, 0, sizeof(stats));
+}
+
+void TwoWire::begin() {}
+void TwoWire::end() {}
+void TwoWire::setClock(uint32_t c) {
+  clock = c;
+}
+
+void TwoWire::attach(uint8_t address, SimI2CDevice* device) {
+  devices[address & 0x7F] = device;
+}
+void TwoWire::detach(uint8_t address) {
+  devices[address & 0x7F] = 0;
+}
+void TwoWire::setFault(uint8_t failures, bool nak, uint32_t micros) {
+  faults = failures;
+  faultNak = nak;
+  faultMicros = micros;
+}
+void TwoWire::setCorruption(uint8_t reads) {
+  corruptReads = reads;
+}
+void TwoWire::holdSDA(uint8_t clocks) {
+  sdaHeld = clocks;
+  simHoldPin(SDA, clocks != 0);
+}
+void TwoWire::sclClock() {
+  if (sdaHeld && !--sdaHeld) simHoldPin(SDA, false);
+}
+
+void TwoWire::account(uint8_t bytes) {  //Start, address byte, data bytes and stop, 9 clocks per byte
+  uint32_t bits = 2 + 9 * (1 + bytes);
+  uint32_t us = (bits * 1000000UL + clock - 1) / clock;
+  stats.transactions++;
+  stats.busMicros += us;
+  simAdvance(us);
+}
+
+void TwoWire::beginTransmission(uint8_t address) {
+  txAddress = address;
+  txLength = 0;
+  transmitting = true;
+}
+
+size_t TwoWire::write(uint8_t data) {
+  if (!transmitting || txLength >= BUFFER_LENGTH) return 0;
+  txBuffer[txLength++] = data;
+  return 1;
+}
+size_t TwoWire::write(const uint8_t* data, size_t length) {
+  size_t n = 0;
+  while (length-- && write(*data++)) n++;
+  return n;
+}
+
+uint8_t TwoWire::endTransmission(bool) {
+  transmitting = false;
+  SimI2CDevice* device = devices[txAddress & 0x7F];
+  if (sdaHeld) {
+    account(0);
+    stats.naks++;
+    return 4;  //Can't even start, arbitration is lost to the held line
+  }
+  if (faults) {
+    faults--;
+    account(0);
+    simAdvance(faultMicros);
+    stats.naks++;
+    return faultNak ? 2 : 4;
+  }
+  if (!device) {
+    account(0);
+    stats.naks++;
+    return 2;  //Address NACK
+  }
+  account(txLength);
+  stats.bytesWritten += txLength;
+  if (!device->i2cWrite(txBuffer, txLength)) {
+    stats.naks++;
+    return 3;  //Data NACK
+  }
+  return 0;
+}
+
+uint8_t TwoWire::requestFrom(uint8_t address, uint8_t quantity, uint8_t) {
+  rxIndex = 0;
+  rxLength = 0;
+  if (quantity > BUFFER_LENGTH) quantity = BUFFER_LENGTH;
+  SimI2CDevice* device = devices[address & 0x7F];
+  if (faults || sdaHeld) {
+    if (faults) faults--;
+    account(0);
+    if (!sdaHeld) simAdvance(faultMicros);
+    stats.naks++;
+    return 0;
+  }
+  if (!device) {
+    account(0);
+    stats.naks++;
+    return 0;
+  }
+  rxLength = device->i2cRead(rxBuffer, quantity);
+  if (corruptReads) {
+    corruptReads--;
+    memset(rxBuffer, 0xFF, rxLength);
+  }
+  account(rxLength);
+  stats.bytesRead += rxLength;
+  return rxLength;
+}
+
+int TwoWire::available() {
+  return rxLength - rxIndex;
+}
+int TwoWire::read() {
+  if (rxIndex >= rxLength) return -1;
+  return rxBuffer[rxIndex++];
+}
+int TwoWire::peek() {
+  if (rxIndex >= rxLength) return -1;
+  return rxBuffer[rxIndex];
+}
+
+SimMeter::SimMeter(TwoWire& bus)
+  : bus(bus), current(0), count(0) {
+  memset(&start, 0, sizeof(start));
+  memset(records, 0, sizeof(records));
+}
+
+void SimMeter::begin(const char* name) {
+  current = name;
+  start = bus.stats;
+}
+
+SimBusStats SimMeter::end() {
+  SimBusStats used;
+  used.transactions = bus.stats.transactions - start.transactions;
+  used.bytesWritten = bus.stats.bytesWritten - start.bytesWritten;
+  used.bytesRead = bus.stats.bytesRead - start.bytesRead;
+  used.naks = bus.stats.naks - start.naks;
+  used.busMicros = bus.stats.busMicros - start.busMicros;
+  if (!current) return used;
+  SimCallRecord* record = (SimCallRecord*)find(current);
+  if (!record && count < sizeof(records) / sizeof(records[0])) {
+    record = &records[count++];
+    record->name = current;
+  }
+  if (record) {
+    record->calls++;
+    record->total.transactions += used.transactions;
+    record->total.bytesWritten += used.bytesWritten;
+    record->total.bytesRead += used.bytesRead;
+    record->total.naks += used.naks;
+    record->total.busMicros += used.busMicros;
+    if (used.busMicros >= record->worst.busMicros) record->worst = used;
+  }
+  current = 0;
+  return used;
+}
+
+const SimCallRecord* SimMeter::find(const char* name) {
+  for (uint8_t i = 0; i < count; i++) {
+    if (!strcmp(records[i].name, name)) return &records[i];
+  }
+  return 0;
+}
+
+void SimMeter::report(FILE* out) {
+  fprintf(out, "%-40s %6s %8s %8s %8s %10s\n", "call", "calls", "trans", "written", "read", "bus us");
+  for (uint8_t i = 0; i < count; i++) {
+    const SimCallRecord& r = records[i];
+    fprintf(out, "%-40s %6u %8u %8u %8u %10llu\n", r.name, r.calls, r.total.transactions, r.total.bytesWritten, r.total.bytesRead, (unsigned long long)r.total.busMicros);
+  }
+}
+
+void SimMeter::reset() {
+  count = 0;
+  current = 0;
+}
@@ -0,0 +1,51 @@
+/*
+  Host side Arduino runtime for UnixRTC: simulated time, pins and interrupts.
+  delay() only moves simulated time forward, so multi-second scenarios run instantly.
+*/
+
+#ifndef SimHost_h
+#define SimHost_h
+
+#include "Arduino.h"
+#include "Wire.h"
+
+class SimClocked {  //Anything that advances with simulated time
+public:
+  SimClocked();
+  virtual ~SimClocked();
+  virtual void advance(uint32_t us) = 0;
+  SimClocked* next;
+};
+
+uint64_t simMicros();                         //Simulated time since start
+void simAdvance(uint32_t us);                 //Moves simulated time forward
+void simSetPin(uint8_t pin, uint8_t level);   //Drives a simulated input pin
+void simHoldPin(uint8_t pin, bool held);      //Another device pulls the pin low, whatever the MCU does
+uint8_t simGetPin(uint8_t pin);
+
+struct SimCallRecord {  //Bus usage of one public method
+  const char* name;
+  uint32_t calls;
+  SimBusStats total;
+  SimBusStats worst;  //Call with the most bus time
+};
+
+class SimMeter {  //Attributes bus traffic to named calls, for I2C budgets
+public:
+  SimMeter(TwoWire& bus = Wire);
+  void begin(const char* name);                //Starts attributing traffic to name
+  SimBusStats end();                           //Stops, returns this call's usage
+  const SimCallRecord* find(const char* name);
+  void report(FILE* out);                      //Table of every recorded call
+  void reset();
+private:
+  TwoWire& bus;
+  const char* current;
+  SimBusStats start;
+  SimCallRecord records[48];
+  uint8_t count;
+};
+
+#define SIM_METER(meter, call) (meter.begin(#call), (call), meter.end())  //Measures one expression, e.g. SIM_METER(meter, rtc.getTime())
+
+#endif
@@ -0,0 +1,73 @@
+/*
+  Host side TwoWire for UnixRTC. Transactions are routed to simulated devices,
+  counted, and take simulated bus time at the configured clock (9 clocks per byte).
+*/
+
+#ifndef Wire_h
+#define Wire_h
+
+#include "Arduino.h"
+
+#define BUFFER_LENGTH 32
+
+class SimI2CDevice {  //A device on the simulated bus
+public:
+  virtual ~SimI2CDevice() {}
+  virtual bool i2cWrite(const uint8_t* data, uint8_t length) = 0;  //Returns false to NACK
+  virtual uint8_t i2cRead(uint8_t* data, uint8_t length) = 0;       //Returns the number of bytes supplied
+};
+
+struct SimBusStats {  //Bus usage counters
+  uint32_t transactions;
+  uint32_t bytesWritten;
+  uint32_t bytesRead;
+  uint32_t naks;
+  uint64_t busMicros;
+};
+
+class TwoWire {
+public:
+  TwoWire();
+  void begin();
+  void end();
+  void setClock(uint32_t clock);
+  void beginTransmission(uint8_t address);
+  void beginTransmission(int address) { beginTransmission((uint8_t)address); }
+  size_t write(uint8_t data);
+  size_t write(const uint8_t* data, size_t length);
+  uint8_t endTransmission(bool sendStop = true);
+  uint8_t requestFrom(uint8_t address, uint8_t quantity, uint8_t sendStop = true);
+  uint8_t requestFrom(int address, int quantity) { return requestFrom((uint8_t)address, (uint8_t)quantity); }
+  int available();
+  int read();
+  int peek();
+
+  void attach(uint8_t address, SimI2CDevice* device);  //Connects a simulated device
+  void detach(uint8_t address);
+  void setFault(uint8_t failures, bool nak = true, uint32_t micros = 0);  //The next transactions fail (NAK or short read), each taking micros of bus time
+  void setCorruption(uint8_t reads);                   //The next reads complete but return 0xFF (a glitch on SDA)
+  void holdSDA(uint8_t clocks);                        //A device holds SDA low, failing every transaction until SCL is clocked this many times
+  void sclClock();                                     //SCL driven low by bus recovery, called by the pin model
+  SimBusStats stats;
+private:
+  SimI2CDevice* devices[128];
+  uint32_t clock;
+  uint8_t txAddress;
+  uint8_t txBuffer[BUFFER_LENGTH];
+  uint8_t txLength;
+  bool transmitting;
+  uint8_t rxBuffer[BUFFER_LENGTH];
+  uint8_t rxLength;
+  uint8_t rxIndex;
+  uint8_t faults;
+  bool faultNak;
+  uint32_t faultMicros;
+  uint8_t corruptReads;
+  uint8_t sdaHeld;  //Clocks until SDA is released, 0 if free
+  void account(uint8_t bytes);
+};
+
+extern TwoWire Wire;
+extern TwoWire Wire1;
+
+#endif
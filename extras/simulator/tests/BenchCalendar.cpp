@@ -0,0 +1,77 @@
+/*
+  Calendar conversion throughput: the original conversion, toDateTime(), the batch conversions
+  and glibc's gmtime_r()/timegm(), in ns per value.
+*/
+
+#include "UnixRTC.h"
+#include "ReferenceCalendar.h"
+#include <stdio.h>
+#include <time.h>
+#include <chrono>
+#include <vector>
+
+static double seconds() {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int main() {
+  const size_t N = 4000000;
+  std::vector<uint64_t> in(N), back(N);
+  std::vector<uint8_t> f[7];
+  for (int k = 0; k < 7; k++) f[k].resize(N);
+  UnixRTCDateFields fields = { f[0].data(), f[1].data(), f[2].data(), f[3].data(), f[4].data(), f[5].data(), f[6].data() };
+  uint64_t t = 946684800ULL, seed = 1;
+  for (size_t i = 0; i < N; i++) {  //Ascending with gaps, wrapping at Y2200
+    seed = seed * 6364136223846793005ULL + 1;
+    t += (seed >> 33) % 3000;
+    if (t >= 7258118400ULL) t = 946684800ULL;
+    in[i] = t;
+  }
+  volatile uint64_t sink = 0;
+
+  double t0 = seconds();
+  for (size_t i = 0; i < N; i++) referenceDateFromUnix(in[i], f[0][i], f[1][i], f[2][i], f[3][i], f[4][i], f[5][i], f[6][i]);
+  double t1 = seconds();
+  for (size_t i = 0; i < N; i++) {
+    UnixRTCDateTime dt;
+    UnixRTC::toDateTime(in[i], dt);
+    f[0][i] = dt.second;
+    f[4][i] = dt.day;
+  }
+  double t2 = seconds();
+  UnixRTC::toCalendar(in.data(), fields, N);
+  double t3 = seconds();
+  UnixRTC::toCalendarSorted(in.data(), fields, N);
+  double t4 = seconds();
+  for (size_t i = 0; i < N; i++) {
+    time_t tt = in[i];
+    struct tm tm;
+    gmtime_r(&tt, &tm);
+    f[0][i] = tm.tm_sec;
+    f[4][i] = tm.tm_mday;
+  }
+  double t5 = seconds();
+  UnixRTC::toCalendarSorted(in.data(), fields, N);  //Every field again for the other direction, untimed
+  double t6 = seconds();
+  for (size_t i = 0; i < N; i++) sink += referenceUnixFromDate(f[0][i], f[1][i], f[2][i], f[4][i], f[5][i], f[6][i]);
+  double t7 = seconds();
+  UnixRTC::fromCalendar(fields, back.data(), N);
+  double t8 = seconds();
+  for (size_t i = 0; i < N; i++) {
+    struct tm tm = {};
+    tm.tm_sec = f[0][i];
+    tm.tm_min = f[1][i];
+    tm.tm_hour = f[2][i];
+    tm.tm_mday = f[4][i];
+    tm.tm_mon = f[5][i] - 1;
+    tm.tm_year = f[6][i] + 100;
+    back[i] = timegm(&tm);
+  }
+  double t9 = seconds();
+
+  printf("ns per value\n");
+  printf("to calendar:   original %.2f, toDateTime %.2f, toCalendar %.2f, toCalendarSorted %.2f, gmtime_r %.2f\n",
+         (t1 - t0) / N * 1e9, (t2 - t1) / N * 1e9, (t3 - t2) / N * 1e9, (t4 - t3) / N * 1e9, (t5 - t4) / N * 1e9);
+  printf("from calendar: original %.2f, fromCalendar %.2f, timegm %.2f\n", (t7 - t6) / N * 1e9, (t8 - t7) / N * 1e9, (t9 - t8) / N * 1e9);
+  return back[N - 1] != in[N - 1];
+}
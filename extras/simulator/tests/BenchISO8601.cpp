@@ -0,0 +1,68 @@
+/*
+  ISO 8601 formatting and parsing throughput against gmtime_r() with strftime()/snprintf(),
+  and strptime() with timegm(), in ns per timestamp.
+*/
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE  //strptime(), timegm()
+#endif
+#include "UnixRTC.h"
+#include <stdio.h>
+#include <time.h>
+#include <chrono>
+
+typedef std::chrono::steady_clock Clock;
+
+static double nanos(Clock::time_point a, Clock::time_point b, int n) {
+  return std::chrono::duration<double, std::nano>(b - a).count() / n;
+}
+
+int main() {
+  const int N = 3000000;
+  const uint64_t base = 1700000000ULL;
+  char ours[RTC_ISO8601_LENGTH], theirs[64];
+  volatile uint64_t sink = 0;
+  uint64_t parsed;
+
+  Clock::time_point t0 = Clock::now();
+  for (int i = 0; i < N; i++) {
+    UnixRTC::formatISO8601(base + i * 7919ULL, ours, sizeof ours);
+    sink += ours[18];
+  }
+  Clock::time_point t1 = Clock::now();
+  for (int i = 0; i < N; i++) {
+    time_t t = base + i * 7919ULL;
+    struct tm tm;
+    gmtime_r(&t, &tm);
+    strftime(theirs, sizeof theirs, "%Y-%m-%dT%H:%M:%SZ", &tm);
+    sink += theirs[18];
+  }
+  Clock::time_point t2 = Clock::now();
+  for (int i = 0; i < N; i++) {
+    time_t t = base + i * 7919ULL;
+    struct tm tm;
+    gmtime_r(&t, &tm);
+    snprintf(theirs, sizeof theirs, "%04d-%02d-%02dT%02d:%02d:%02dZ", tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec);
+    sink += theirs[18];
+  }
+  Clock::time_point t3 = Clock::now();
+  for (int i = 0; i < N; i++) {
+    UnixRTC::formatISO8601(base + i * 7919ULL, ours, sizeof ours);
+    UnixRTC::parseISO8601(ours, parsed);
+    sink += parsed;
+  }
+  Clock::time_point t4 = Clock::now();
+  for (int i = 0; i < N; i++) {
+    time_t t = base + i * 7919ULL;
+    struct tm tm, back = {};
+    gmtime_r(&t, &tm);
+    strftime(theirs, sizeof theirs, "%Y-%m-%dT%H:%M:%SZ", &tm);
+    strptime(theirs, "%Y-%m-%dT%H:%M:%SZ", &back);
+    sink += timegm(&back);
+  }
+  Clock::time_point t5 = Clock::now();
+
+  printf("format: formatISO8601 %.1f ns, gmtime_r+strftime %.1f ns, gmtime_r+snprintf %.1f ns\n", nanos(t0, t1, N), nanos(t1, t2, N), nanos(t2, t3, N));
+  printf("format+parse: formatISO8601+parseISO8601 %.1f ns, strftime+strptime+timegm %.1f ns\n", nanos(t3, t4, N), nanos(t4, t5, N));
+  return 0;
+}
@@ -0,0 +1,33 @@
+/*
+  UnixRTCTimeZone::toLocal() for consecutive readings against glibc's localtime_r() with the same rule.
+*/
+
+#include "UnixRTCTimeZone.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <chrono>
+
+typedef std::chrono::steady_clock Clock;
+
+int main() {
+  const char* rule = "CET-1CEST,M3.5.0,M10.5.0/3";
+  const int N = 50000000, M = N / 50;
+  volatile uint64_t sink = 0;
+  UnixRTCTimeZone tz;
+  if (!tz.begin(rule)) return 1;
+  Clock::time_point t0 = Clock::now();
+  for (int i = 0; i < N; i++) sink += tz.toLocal(1700000000ULL + i / 8);  //8 readings a second
+  Clock::time_point t1 = Clock::now();
+  setenv("TZ", rule, 1);
+  tzset();
+  for (int i = 0; i < M; i++) {
+    time_t t = 1700000000ULL + i / 8;
+    struct tm tm;
+    localtime_r(&t, &tm);
+    sink += tm.tm_gmtoff;
+  }
+  Clock::time_point t2 = Clock::now();
+  printf("toLocal %.2f ns, localtime_r %.1f ns\n", std::chrono::duration<double, std::nano>(t1 - t0).count() / N, std::chrono::duration<double, std::nano>(t2 - t1).count() / M);
+  return 0;
+}
@@ -0,0 +1,40 @@
+/*
+  The calendar conversion UnixRTC shipped with before the table driven one, kept as a reference
+  for TestCalendar and BenchCalendar. Year counts from 2000 (0-199), dayOfWeek is 0-6 with 0 being Sunday.
+*/
+
+#ifndef ReferenceCalendar_h
+#define ReferenceCalendar_h
+
+#include <stdint.h>
+
+static inline uint64_t referenceUnixFromDate(uint8_t second, uint8_t minute, uint8_t hour, uint8_t day, uint8_t month, uint8_t year) {
+  uint8_t my = (month >= 3) ? 1 : 0;
+  uint16_t y = year + 30 + my;
+  uint16_t dm = 0;
+  for (int i = 0; i < month - 1; i++) dm += (i < 7) ? ((i == 1) ? 28 : ((i & 1) ? 30 : 31)) : ((i & 1) ? 31 : 30);
+  return ((((day - 1 + dm + ((y + 1) / 4) - ((y + 69) / 100) + ((y + 369) / 400)) + (365UL * (y - my))) * (uint32_t)24 + hour) * (uint32_t)60 + minute) * (uint64_t)60 + second;
+}
+
+static inline void referenceDateFromUnix(uint64_t unix, uint8_t& second, uint8_t& minute, uint8_t& hour, uint8_t& dayOfWeek, uint8_t& day, uint8_t& month, uint8_t& year) {
+  second = unix % 60;
+  uint32_t t = unix / 60;
+  minute = t % 60;
+  t /= 60;
+  hour = t % 24;
+  t /= 24;
+  dayOfWeek = (t + 4) % 7;
+  uint32_t z = t + 719468;
+  uint8_t era = z / 146097ul;
+  uint32_t doe = z - era * 146097ul;
+  uint32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+  uint32_t y = yoe + era * 400;
+  uint32_t doy = doe - (yoe * 365 + yoe / 4 - yoe / 100);
+  uint32_t mp = (doy * 5 + 2) / 153;
+  day = doy - (mp * 153 + 2) / 5 + 1;
+  month = mp + (mp < 10 ? 3 : -9);
+  y += (month <= 2);
+  year = y - 2000;
+}
+
+#endif
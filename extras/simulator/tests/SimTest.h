@@ -0,0 +1,37 @@
+/*
+  Minimal checks for the simulator tests: CHECK() reports the failing line and keeps going,
+  SIM_TEST_RESULT() prints the verdict and is the exit status of main(). SimFixture is the
+  simulated DS3231 on Wire with a UnixRTC begun on it.
+*/
+
+#ifndef SimTest_h
+#define SimTest_h
+
+#include <stdio.h>
+#include "DS3231Sim.h"
+#include "UnixRTC.h"
+
+static int simTestFailures = 0;
+
+#define CHECK(c) do { if (!(c)) { printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #c); simTestFailures++; } } while (0)
+#define FAIL(...) do { printf("%s:%d: ", __FILE__, __LINE__); printf(__VA_ARGS__); printf("\n"); simTestFailures++; } while (0)
+#define SIM_TEST_RESULT() (printf(simTestFailures ? "FAILED (%d)\n" : "OK\n", simTestFailures), simTestFailures != 0)
+
+struct SimFixture : DS3231Sim {  //The chip, with rtc begun and set to time unless it is 0
+  UnixRTC& rtc;
+  explicit SimFixture(uint64_t time = 0) : rtc(own) {
+    start(time);
+  }
+  SimFixture(UnixRTC& rtc, uint64_t time = 0) : rtc(rtc) {  //For a UnixRTC that interrupt handlers reach
+    start(time);
+  }
+
+private:
+  UnixRTC own;
+  void start(uint64_t time) {
+    rtc.begin();
+    if (time) CHECK(rtc.setTime(time));
+  }
+};
+
+#endif
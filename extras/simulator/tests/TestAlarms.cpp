@@ -0,0 +1,111 @@
+/*
+  Alarm repeat modes: getAlarm1Time()/getAlarm2Time() predict the chip's next trip for every mode,
+  and the interrupt driven service() calls back once per trip without idle bus traffic.
+*/
+
+#include "SimTest.h"
+
+static int n1 = 0, n2 = 0, both = 0;
+static void onAlarm(uint8_t alarms) {
+  if (alarms & RTC_ALM1) n1++;
+  if (alarms & RTC_ALM2) n2++;
+  if (alarms == (RTC_ALM1 | RTC_ALM2)) both++;
+}
+
+static bool tripped(UnixRTC& rtc, int alarm) {  //Reads and clears the flag
+  return alarm == 1 ? rtc.alm1Tripped(true) : rtc.alm2Tripped(true);
+}
+static uint64_t predicted(UnixRTC& rtc, int alarm) {
+  return alarm == 1 ? rtc.getAlarm1Time() : rtc.getAlarm2Time();
+}
+
+int main() {
+  SimFixture sim;
+  UnixRTC& rtc = sim.rtc;
+  const uint64_t t0 = 1700000000ULL;  //Tue 2023-11-14 22:13:20
+  struct {
+    int alarm;
+    uint8_t mode;
+    uint64_t at;
+  } cases[] = {
+    { 1, RTC_ALARM_PER_SECOND, t0 }, { 1, RTC_ALARM_PER_MINUTE, t0 + 30 }, { 1, RTC_ALARM_PER_HOUR, t0 + 3000 },
+    { 1, RTC_ALARM_PER_DAY, t0 + 50000 }, { 1, RTC_ALARM_PER_WEEK, t0 + 3 * 86400 + 77 }, { 1, RTC_ALARM_PER_MONTH, t0 + 17 * 86400 + 5 },
+    { 2, RTC_ALARM_PER_MINUTE, t0 }, { 2, RTC_ALARM_PER_HOUR, t0 + 1200 }, { 2, RTC_ALARM_PER_DAY, t0 + 7000 },
+    { 2, RTC_ALARM_PER_WEEK, t0 + 5 * 86400 + 900 }, { 2, RTC_ALARM_PER_MONTH, t0 + 20 * 86400 }
+  };
+  for (auto& c : cases) {
+    rtc.setTime(t0);
+    CHECK(c.alarm == 1 ? rtc.setAlarm1Time(c.at, c.mode) : rtc.setAlarm2Time(c.at, c.mode));
+    CHECK((c.alarm == 1 ? rtc.getAlarm1Mode() : rtc.getAlarm2Mode()) == c.mode);
+    rtc.clearAlm1();
+    rtc.clearAlm2();
+    for (int s = 0; s < 7200; s++) {  //Two hours a second at a time, the prediction checked every second
+      simAdvance(1000000);
+      uint64_t now = rtc.getTime();
+      bool trip = tripped(rtc, c.alarm);
+      uint64_t next = predicted(rtc, c.alarm);
+      if (rtc.getTime() != now) continue;  //Ticked meanwhile, bus time moves the phase
+      if (trip != (next == now)) FAIL("alarm %d mode %d: trip %d at %llu, predicted %llu", c.alarm, c.mode, trip, (unsigned long long)now, (unsigned long long)next);
+    }
+    for (int n = 0; n < 3; n++) {  //Then straight to just before each of the next predicted trips
+      simAdvance(1000000);
+      uint64_t now = rtc.getTime();
+      uint64_t next = predicted(rtc, c.alarm);
+      CHECK(next >= now);
+      if (next > now + 2) {
+        rtc.setTime(next - 2);
+        tripped(rtc, c.alarm);
+        now = next - 2;
+      }
+      while (now < next) {
+        if (tripped(rtc, c.alarm)) FAIL("alarm %d mode %d tripped at %llu, predicted %llu", c.alarm, c.mode, (unsigned long long)now, (unsigned long long)next);
+        simAdvance(1000000);
+        now = rtc.getTime();
+      }
+      if (now != next || !tripped(rtc, c.alarm)) FAIL("alarm %d mode %d didn't trip at %llu", c.alarm, c.mode, (unsigned long long)next);
+    }
+  }
+  CHECK(!rtc.setAlarm2Time(t0, RTC_ALARM_PER_SECOND));
+  CHECK(!rtc.setAlarm1Time(t0, 9));
+
+  //Monthly on the 31st skips shorter months
+  rtc.setTime(1711929600ULL);                       //2024-04-01
+  rtc.setAlarm1Time(1711929600ULL - 86400 + 3600);  //Mar 31st 01:00, next is May 31st
+  CHECK(rtc.getAlarm1Time() == 1711929600ULL + 60ULL * 86400 + 3600);
+  UnixRTCSnapshot snap;
+  rtc.readSnapshot(snap);
+  CHECK(snap.alarm1Mode == RTC_ALARM_PER_MONTH && snap.alarm1 == rtc.getAlarm1Time());
+
+  //Interrupt driven
+  sim.connectIntPin(4);
+  rtc.setTime(t0);
+  rtc.setAlarm1Time(t0 + 15, RTC_ALARM_PER_MINUTE);
+  rtc.setAlarm2Time(t0 + 45, RTC_ALARM_PER_MINUTE);  //Every minute at :00
+  simAdvance(100000000);                             //Stale flags
+  CHECK(rtc.alm1Tripped());
+  rtc.attachAlarmInterrupt(4, onAlarm);
+  CHECK(!rtc.SQWEnabled() && rtc.alm1InterrptEnabled() && rtc.alm2InterrptEnabled());
+  CHECK(!rtc.alm1Tripped());  //Cleared on attach
+  uint32_t idle = 0;
+  for (int s = 0; s < 3600; s++) {
+    simAdvance(1000000);
+    uint32_t before = Wire.stats.transactions;
+    if (!rtc.service()) idle += Wire.stats.transactions - before;
+  }
+  CHECK(n1 == 60 && n2 == 60 && idle == 0);
+  rtc.setAlarm1Time(t0 + 40, RTC_ALARM_PER_MINUTE);  //Both on :00
+  n1 = n2 = 0;
+  for (int s = 0; s < 600; s++) {
+    simAdvance(1000000);
+    rtc.service();
+  }
+  CHECK(both >= 9 && n1 == both && n2 == both);
+  rtc.detachAlarmInterrupt();
+  int before = n1;
+  for (int s = 0; s < 120; s++) {
+    simAdvance(1000000);
+    rtc.service();
+  }
+  CHECK(n1 == before);
+  return SIM_TEST_RESULT();
+}
@@ -0,0 +1,50 @@
+/*
+  UnixRTCAsync: queued reads are merged into one burst, each poll() is one short bus step,
+  and every callback gets the fields it asked for.
+*/
+
+#include "UnixRTCAsync.h"
+#include "SimTest.h"
+
+static UnixRTCSnapshot results[6];
+static int hits = 0;
+static void onRead(const UnixRTCSnapshot& snapshot, void* context) {
+  results[(intptr_t)context] = snapshot;
+  hits++;
+}
+
+int main() {
+  SimFixture sim(1777777777);
+  UnixRTC& rtc = sim.rtc;
+  UnixRTCAsync async(rtc);
+  rtc.setAlarm1Time(1777777777 + 100);
+  sim.setTemperature(23.5);
+  rtc.getTempInt(true);
+
+  CHECK(async.read(RTC_READ_TIME, onRead, (void*)RTC_READ_TIME));
+  CHECK(async.read(RTC_READ_ALARM1, onRead, (void*)RTC_READ_ALARM1));
+  CHECK(async.read(RTC_READ_FLAGS, onRead, (void*)RTC_READ_FLAGS));
+  CHECK(async.read(RTC_READ_TEMP, onRead, (void*)RTC_READ_TEMP));
+  CHECK(async.pending() == 4);
+  SimBusStats before = Wire.stats;
+  int polls = 1;
+  while (async.poll()) polls++;
+  CHECK(hits == 4 && async.pending() == 0);
+  CHECK(Wire.stats.transactions - before.transactions == 2 && Wire.stats.bytesRead - before.bytesRead == 0x13);  //One burst
+  CHECK(polls == 1);  //A pointer write and a read per poll()
+  CHECK(results[RTC_READ_TIME].time == 1777777777);
+  CHECK(results[RTC_READ_ALARM1].alarm1 == 1777777777 + 100);
+  CHECK(results[RTC_READ_FLAGS].timeValid && !results[RTC_READ_FLAGS].alm1Tripped);
+  CHECK(results[RTC_READ_TEMP].temp == 94);
+
+  //Short bursts: the time registers stay together, the rest is read 4 bytes at a time
+  async.setMaxBurst(4);
+  CHECK(async.read(RTC_READ_ALL, onRead, (void*)RTC_READ_ALL));
+  before = Wire.stats;
+  polls = 1;
+  while (async.poll()) polls++;
+  CHECK(hits == 5);
+  CHECK(polls == 4 && Wire.stats.transactions - before.transactions == 2 * 4);  //0x00-0x06, then 0x07-0x12 in 3 steps
+  CHECK(results[RTC_READ_ALL].time == 1777777777 && results[RTC_READ_ALL].alarm1 == 1777777777 + 100 && results[RTC_READ_ALL].temp == 94);
+  return SIM_TEST_RESULT();
+}
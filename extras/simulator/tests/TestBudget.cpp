@@ -0,0 +1,103 @@
+/*
+  I2C budgets: the transactions each public call may take on the bus. A change that adds
+  a transaction to one of these paths has to update the budget here on purpose.
+*/
+
+#include "SimTest.h"
+
+UnixRTC rtc;
+void onSQW() { rtc.sqwEdge(); }
+
+int main() {
+  SimFixture sim(rtc);
+  SimMeter meter;
+
+  CHECK(SIM_METER(meter, rtc.setTime(1777777777)).transactions == 6);  //Time, then the status and control read-modify-writes (OSF, EOSC)
+  delay(3000);
+  SimBusStats used = SIM_METER(meter, rtc.getTime());
+  CHECK(used.transactions == 2 && used.bytesRead == 7);
+  CHECK(SIM_METER(meter, rtc.timeValid()).transactions == 2);
+  CHECK(SIM_METER(meter, rtc.setAlarm1Time(1777777777 + 86400 * 3 + 5)).transactions == 1);
+  CHECK(SIM_METER(meter, rtc.setAlarm2Time(1777777777 + 3600)).transactions == 1);
+  CHECK(SIM_METER(meter, rtc.getAlarm1Time()).transactions == 2);  //Alarm and time in one read
+  CHECK(SIM_METER(meter, rtc.getAlarm2Time()).transactions == 2);
+
+  UnixRTCSnapshot snap;
+  used = SIM_METER(meter, rtc.readSnapshot(snap));
+  CHECK(used.transactions == 2 && used.bytesRead == 0x13);  //Whole register map in one read
+  CHECK(snap.time >= 1777777780 && snap.time <= 1777777781 && snap.timeValid);
+
+  //Configuration: one read and one write for everything the builder changes
+  used = SIM_METER(meter, rtc.beginConfig().sqw(RTC_1KHz).batteryBackedSQW(true).alarm1Interrupt(false).alarm2Interrupt(false).enable32KHz(false).commit());
+  CHECK(used.transactions == 3);
+  used = SIM_METER(meter, rtc.beginConfig().oscillator(true).sqw(RTC_8KHz).agingOffset(-5).commit());
+  CHECK(used.transactions == 3);  //The aging offset goes out in the same write
+
+  //Shadow registers: setters don't read back
+  rtc.enableBatteryBackedSQW();  //So that each setter below changes a bit
+  rtc.disable32KHzOut();
+  rtc.enableSQW();
+  rtc.enableShadowRegisters();
+  meter.begin("shadow setters");
+  rtc.setSQWFreq(RTC_4KHz);
+  rtc.disableBatteryBackedSQW();
+  rtc.enableAlm1Interrupt();
+  rtc.enableAlm2Interrupt();
+  rtc.enable32KHzOut();
+  rtc.disableSQW();
+  used = meter.end();
+  CHECK(used.transactions == 2 + 6);  //Loading the shadow, then a write per setter
+  CHECK(SIM_METER(meter, rtc.setTime(1777777777)).transactions == 2);  //Time, and the OSF clear without a read
+  CHECK(SIM_METER(meter, rtc.assumeTimeValid()).transactions == 1);
+  CHECK(SIM_METER(meter, rtc.getSQWFreq()).transactions == 0);
+  rtc.enableShadowRegisters(false);
+
+  //Interrupt driven alarms: service() stays off the bus while INT is high
+  sim.connectIntPin(4);
+  rtc.setAlarm1Time(1777777777 + 15, RTC_ALARM_PER_MINUTE);
+  rtc.attachAlarmInterrupt(4, nullptr);
+  uint32_t idle = 0, fired = 0;
+  for (int s = 0; s < 600; s++) {
+    simAdvance(1000000);
+    uint32_t before = Wire.stats.transactions;
+    if (rtc.service()) fired++;
+    else idle += Wire.stats.transactions - before;
+  }
+  CHECK(fired == 10 && idle == 0);
+  rtc.detachAlarmInterrupt();
+
+  //SQW disciplined software clock: reads cost nothing
+  sim.connectIntPin(2);
+  pinMode(2, INPUT_PULLUP);
+  attachInterrupt(digitalPinToInterrupt(2), onSQW, FALLING);
+  rtc.beginSoftClock();
+  delay(2000);
+  meter.begin("getTimeUs");
+  for (int i = 0; i < 1000; i++) {
+    rtc.getTimeUs();
+    delayMicroseconds(777);
+  }
+  CHECK(meter.end().transactions == 0);
+  detachInterrupt(2);
+
+  //Incremental reads: under half the bus time of full reads at 1 Hz
+  UnixRTC inc;
+  inc.begin();
+  meter.begin("full getTime x600");
+  for (int i = 0; i < 600; i++) {
+    delay(1000);
+    inc.getTime();
+  }
+  SimBusStats full = meter.end();
+  inc.enableIncrementalReads();
+  meter.begin("incremental getTime x600");
+  for (int i = 0; i < 600; i++) {
+    delay(1000);
+    inc.getTime();
+  }
+  SimBusStats partial = meter.end();
+  CHECK(partial.busMicros * 2 < full.busMicros);
+
+  meter.report(stdout);
+  return SIM_TEST_RESULT();
+}
@@ -0,0 +1,130 @@
+/*
+  Calendar conversion against the original UnixRTC code (ReferenceCalendar.h) and glibc:
+  single values over Y2000-Y2199, the batch conversions, and the UnixRTCDateTime helpers.
+*/
+
+#include "UnixRTC.h"
+#include "ReferenceCalendar.h"
+#include "SimTest.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <vector>
+
+static const uint64_t FIRST = 946684800ULL;  //2000-01-01
+static const uint64_t END = 7258118400ULL;   //2200-01-01
+
+static bool same(const UnixRTCDateTime& a, const UnixRTCDateTime& b) {
+  return a.second == b.second && a.minute == b.minute && a.hour == b.hour && a.dayOfWeek == b.dayOfWeek && a.day == b.day && a.month == b.month && a.year == b.year;
+}
+
+static uint64_t random64() {
+  return ((uint64_t)rand() << 31) ^ rand();
+}
+
+int main() {
+  srand(5);
+
+  //Strided walk, every value checked both ways
+  uint32_t bad = 0;
+  for (uint64_t t = FIRST; t < END; t += 997) {
+    UnixRTCDateTime dt;
+    uint8_t r[7];
+    UnixRTC::toDateTime(t, dt);
+    referenceDateFromUnix(t, r[0], r[1], r[2], r[3], r[4], r[5], r[6]);
+    if (dt.second != r[0] || dt.minute != r[1] || dt.hour != r[2] || dt.dayOfWeek != r[3] || dt.day != r[4] || dt.month != r[5] || dt.year != r[6]) bad++;
+    else if (UnixRTC::fromDateTime(dt) != t || referenceUnixFromDate(r[0], r[1], r[2], r[4], r[5], r[6]) != t) bad++;
+  }
+  CHECK(bad == 0);
+
+  //Batch conversions, random and sorted input
+  const size_t N = 400000;
+  std::vector<uint64_t> in(N), back(N);
+  std::vector<uint8_t> f[7];
+  for (int k = 0; k < 7; k++) f[k].resize(N);
+  UnixRTCDateFields out = { f[0].data(), f[1].data(), f[2].data(), f[3].data(), f[4].data(), f[5].data(), f[6].data() };
+  uint64_t t = FIRST;
+  for (size_t i = 0; i < N; i++) {
+    t += random64() % 30000;
+    if (t >= END) t = FIRST;
+    in[i] = t;
+  }
+  for (int sorted = 0; sorted < 2; sorted++) {
+    if (sorted) UnixRTC::toCalendarSorted(in.data(), out, N);
+    else UnixRTC::toCalendar(in.data(), out, N);
+    bad = 0;
+    for (size_t i = 0; i < N; i++) {
+      uint8_t r[7];
+      referenceDateFromUnix(in[i], r[0], r[1], r[2], r[3], r[4], r[5], r[6]);
+      for (int k = 0; k < 7; k++) bad += f[k][i] != r[k];
+    }
+    CHECK(bad == 0);
+  }
+  UnixRTC::fromCalendar(out, back.data(), N);
+  CHECK(back == in);
+
+  //Day of year, ISO week and weekday over every day, against glibc
+  bad = 0;
+  for (uint64_t d = FIRST; d < END; d += 86400) {
+    UnixRTCDateTime dt;
+    UnixRTC::toDateTime(d + 3723, dt);
+    time_t tt = (time_t)(d + 3723);
+    struct tm tm;
+    gmtime_r(&tt, &tm);
+    char buf[16];
+    strftime(buf, sizeof buf, "%G %V", &tm);
+    int isoYear, week;
+    sscanf(buf, "%d %d", &isoYear, &week);
+    uint16_t y;
+    if (UnixRTC::isoWeek(dt, &y) != week || y != isoYear || UnixRTC::dayOfYear(dt) != tm.tm_yday + 1 || dt.dayOfWeek != tm.tm_wday) bad++;
+  }
+  CHECK(bad == 0);
+
+  //addSeconds()/addDays() against unix arithmetic, including the range limits
+  bad = 0;
+  for (int i = 0; i < 200000; i++) {
+    uint64_t u = FIRST + random64() % (END - FIRST);
+    int32_t s = (int32_t)(random64() % 4294967295ULL - 2147483647LL);
+    int32_t days = (int32_t)(rand() % 160001) - 80000;
+    UnixRTCDateTime dt, expect, orig;
+    UnixRTC::toDateTime(u, orig);
+    dt = orig;
+    int64_t moved = (int64_t)u + s;
+    bool inRange = moved >= (int64_t)FIRST && moved < (int64_t)END;
+    if (UnixRTC::addSeconds(dt, s) != inRange) bad++;
+    else if (inRange) {
+      UnixRTC::toDateTime(moved, expect);
+      if (!same(dt, expect)) bad++;
+    } else if (!same(dt, orig)) bad++;
+    dt = orig;
+    moved = (int64_t)u + (int64_t)days * 86400;
+    inRange = moved >= (int64_t)FIRST && moved < (int64_t)END;
+    if (UnixRTC::addDays(dt, days) != inRange) bad++;
+    else if (inRange) {
+      UnixRTC::toDateTime(moved, expect);
+      if (!same(dt, expect)) bad++;
+    } else if (!same(dt, orig)) bad++;
+  }
+  CHECK(bad == 0);
+  UnixRTCDateTime edge;
+  UnixRTC::toDateTime(END - 1, edge);
+  CHECK(!UnixRTC::addSeconds(edge, 1));
+  CHECK(UnixRTC::addSeconds(edge, -86400));
+  UnixRTC::toDateTime(FIRST, edge);
+  CHECK(!UnixRTC::addSeconds(edge, -1));
+  CHECK(!UnixRTC::addDays(edge, -1));
+
+  //Validation
+  UnixRTCDateTime dt = { 30, 15, 13, 6, 17, 10, 26 };
+  CHECK(UnixRTC::dateTimeValid(dt));
+  dt.month = 2;
+  dt.day = 29;
+  CHECK(!UnixRTC::dateTimeValid(dt));  //2026
+  dt.year = 100;
+  CHECK(!UnixRTC::dateTimeValid(dt));
+  dt.year = 104;
+  CHECK(UnixRTC::dateTimeValid(dt));
+  dt.year = 200;
+  CHECK(!UnixRTC::dateTimeValid(dt));
+  return SIM_TEST_RESULT();
+}
@@ -0,0 +1,54 @@
+/*
+  Control and status configuration: the Config builder, setters with and without shadow registers,
+  and the OSF clear of setTime() in shadow mode.
+*/
+
+#include "SimTest.h"
+
+int main() {
+  SimFixture sim;
+  UnixRTC& rtc = sim.rtc;
+
+  CHECK(rtc.beginConfig().sqw(RTC_1KHz).batteryBackedSQW(true).alarm1Interrupt(false).alarm2Interrupt(false).enable32KHz(false).commit());
+  CHECK(rtc.getSQWFreq() == 1024 && rtc.SQWEnabled() && rtc.batteryBackedSQWEnabled() && !rtc.output32KHzEnabled());
+  CHECK(sim.regs[0x0F] & 0x80);  //OSF left alone
+  CHECK(rtc.beginConfig().oscillator(true).sqw(RTC_8KHz).batteryBackedSQW(false).alarm1Interrupt(true).alarm2Interrupt(false).enable32KHz(true).agingOffset(-5).commit());
+  CHECK(rtc.getSQWFreq() == 8192 && rtc.SQWEnabled() && rtc.alm1InterrptEnabled() && !rtc.alm2InterrptEnabled() && rtc.output32KHzEnabled());
+  CHECK(rtc.getAgingOffset() == -5 && (int8_t)sim.regs[0x10] == -5);
+  CHECK(!rtc.beginConfig().sqw(5).commit());
+
+  //Plain setters, then the same through shadow registers
+  rtc.setSQWFreq(RTC_1KHz);
+  rtc.enableBatteryBackedSQW();
+  rtc.disableAlm1Interrupt();
+  rtc.disableAlm2Interrupt();
+  rtc.disable32KHzOut();
+  rtc.enableSQW();
+  CHECK(rtc.getSQWFreq() == 1024 && rtc.batteryBackedSQWEnabled() && !rtc.alm1InterrptEnabled() && !rtc.output32KHzEnabled() && rtc.SQWEnabled());
+  rtc.enableShadowRegisters();
+  rtc.setSQWFreq(RTC_4KHz);
+  rtc.disableBatteryBackedSQW();
+  rtc.enableAlm1Interrupt();
+  rtc.enableAlm2Interrupt();
+  rtc.enable32KHzOut();
+  rtc.disableSQW();
+  CHECK(rtc.getSQWFreq() == 4096 && !rtc.batteryBackedSQWEnabled() && rtc.alm1InterrptEnabled() && rtc.output32KHzEnabled() && !rtc.SQWEnabled());
+  CHECK((sim.regs[0x0E] & 0x7F) == ((2 << 3) | 7));
+  CHECK(sim.regs[0x0F] & 0x08);  //EN32kHz
+  CHECK(sim.regs[0x0F] & 0x80);  //OSF left alone
+
+  //setTime() in shadow mode clears OSF every time, it sets again behind the shadow on an RTC-only power loss
+  CHECK(rtc.setTime(1700000000));
+  CHECK(rtc.timeValid());
+  rtc.disableOscillator();
+  sim.setVcc(false);  //The oscillator stops on battery
+  delay(2000);
+  sim.setVcc(true);
+  CHECK(sim.regs[0x0F] & 0x80);
+  SimBusStats before = Wire.stats;
+  CHECK(rtc.setTime(1700000100));
+  CHECK(Wire.stats.transactions - before.transactions == 3);  //The time, then the status and control writes without reads
+  CHECK(rtc.timeValid() && !(sim.regs[0x0F] & 0x80) && !(sim.regs[0x0E] & 0x80));
+  CHECK(sim.regs[0x0F] & 0x08);  //Cached EN32kHz kept
+  return SIM_TEST_RESULT();
+}
@@ -0,0 +1,57 @@
+/*
+  getDateTime()/setDateTime(): one 7 byte read agreeing with getTime(), the weekday computed on write,
+  range checks, and the Y2100 correction through the struct path.
+*/
+
+#include "SimTest.h"
+#include <stdlib.h>
+
+static bool same(const UnixRTCDateTime& a, const UnixRTCDateTime& b) {
+  return a.second == b.second && a.minute == b.minute && a.hour == b.hour && a.dayOfWeek == b.dayOfWeek && a.day == b.day && a.month == b.month && a.year == b.year;
+}
+
+int main() {
+  SimFixture sim;
+  UnixRTC& rtc = sim.rtc;
+  CHECK(sizeof(UnixRTCDateTime) == 7);
+  srand(24);
+
+  uint32_t bad = 0;
+  for (int i = 0; i < 2000; i++) {
+    uint64_t t = 946684800ULL + ((uint64_t)rand() * rand()) % (7258118400ULL - 946684800ULL - 10);
+    CHECK(rtc.setTime(t));
+    SimBusStats before = Wire.stats;
+    UnixRTCDateTime dt, expect;
+    CHECK(rtc.getDateTime(dt));
+    CHECK(Wire.stats.transactions - before.transactions == 2 && Wire.stats.bytesRead - before.bytesRead == 7);
+    uint64_t now = rtc.getTime();
+    UnixRTC::toDateTime(now, expect);
+    if (!same(dt, expect) || UnixRTC::fromDateTime(dt) != now) bad++;
+  }
+  CHECK(bad == 0);
+
+  UnixRTCDateTime w = { 30, 15, 13, 2, 17, 10, 26 };  //2026-10-17 13:15:30, a Saturday, dayOfWeek wrong on purpose
+  CHECK(rtc.setDateTime(w));
+  CHECK(sim.regs[3] == 7);
+  UnixRTCDateTime r;
+  CHECK(rtc.getDateTime(r));
+  CHECK(r.dayOfWeek == 6 && r.hour == 13 && r.year == 26);
+  CHECK(rtc.getTime() == 1792242930ULL);
+  UnixRTCDateTime invalid = w;
+  invalid.month = 2;
+  invalid.day = 29;
+  invalid.year = 100;
+  CHECK(!rtc.setDateTime(invalid));
+  invalid = w;
+  invalid.hour = 24;
+  CHECK(!rtc.setDateTime(invalid));
+  CHECK(rtc.getTime() == 1792242930ULL);
+
+  CHECK(rtc.setTime(4107542400ULL - 5));  //Feb 28th 2100 23:59:55
+  delay(10000);
+  CHECK(rtc.getDateTime(r));
+  CHECK(r.month == 3 && r.day == 1 && r.year == 100 && r.second == 5);
+  CHECK(r.dayOfWeek == 1 && sim.regs[3] == 2);  //Monday, not moved by the correction
+  CHECK(rtc.getTime() == 4107542405ULL);
+  return SIM_TEST_RESULT();
+}
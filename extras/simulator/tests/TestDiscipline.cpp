@@ -0,0 +1,56 @@
+/*
+  UnixRTCDiscipline: converges on the aging offset for a synthetic crystal with temperature
+  dependence and noise, and for the simulated DS3231 running fast.
+*/
+
+#include "UnixRTCDiscipline.h"
+#include "SimTest.h"
+#include <math.h>
+#include <stdlib.h>
+
+int main() {
+  {
+    UnixRTCMockBus mock;  //Aging writes land in its registers
+    UnixRTC rtc(mock);
+    rtc.begin();
+    UnixRTCDiscipline d(rtc);
+    CHECK(d.begin() && d.agingOffset() == 0);
+    CHECK(d.uncertaintyPPM() == UNIXRTC_DRIFT_SPEC_PPM);
+    const double native = 3.73;  //ppm
+    double reference = 1.7e12, rtcMs = reference;
+    srand(1);
+    for (int k = 0; k < 40; k++) {
+      double temp = 25 * 4 + 20 * sin(k * 0.7);  //x4 deg C
+      double ppm = native + 0.01 * (temp - 100) - d.agingOffset() * 0.1;
+      double interval = 6 * 3600e3;
+      reference += interval;
+      rtcMs += interval * (1 + ppm * 1e-6);
+      d.observe((uint64_t)reference, (uint64_t)(rtcMs + (rand() % 11) - 5), (int16_t)temp);
+      CHECK(d.apply());
+      int32_t offset = d.offset();
+      rtcMs -= offset;  //Resynchronised
+      d.stepped(-offset);
+    }
+    CHECK(d.agingOffset() == 37 || d.agingOffset() == 38);
+    CHECK((int8_t)mock.regs[0x10] == d.agingOffset());
+    CHECK(fabs(d.residualPPM()) < 0.3);
+    CHECK(d.nextResync(50) > 6 * 3600);
+  }
+  {
+    SimFixture sim(1700000000);
+    sim.driftPPM = 2.5;
+    UnixRTC& rtc = sim.rtc;
+    UnixRTCDiscipline d(rtc);
+    CHECK(d.begin());
+    uint64_t base = 1700000000000ULL - simMicros() / 1000;  //Reference is the true time
+    for (int k = 0; k < 6; k++) {
+      delay(4 * 3600 * 1000UL);
+      uint64_t reference = base + simMicros() / 1000;
+      uint64_t rtcMs = rtc.getTime() * 1000 + sim.subSecondMicros() / 1000;
+      d.observe(reference, rtcMs, rtc.getTempInt());
+      d.apply();
+    }
+    CHECK(d.agingOffset() == 25);
+  }
+  return SIM_TEST_RESULT();
+}
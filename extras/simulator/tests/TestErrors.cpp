@@ -0,0 +1,139 @@
+/*
+  Error handling: retries on NAKs and implausible reads, lastError(), the time budget, bus recovery,
+  and failed reads that must not be decoded or written back.
+*/
+
+#include "UnixRTCAsync.h"
+#include "SimTest.h"
+#include <string.h>
+
+static UnixRTCSnapshot got;
+static bool gotIt;
+static void onRead(const UnixRTCSnapshot& s, void*) {
+  got = s;
+  gotIt = true;
+}
+
+int main() {
+  SimFixture sim(1700000000);
+  UnixRTC& rtc = sim.rtc;
+  CHECK(rtc.lastError() == RTC_OK);
+
+  //Transient NAK is retried, persistent one fails
+  Wire.setFault(2);
+  uint64_t t = rtc.getTime();
+  CHECK(t >= 1700000000 && t < 1700000005);
+  CHECK(rtc.lastError() == RTC_ERR_NACK_ADDRESS);
+  Wire.setFault(3);
+  CHECK(rtc.getTime() == 0);
+  CHECK(rtc.lastError() == RTC_ERR_NACK_ADDRESS);
+  CHECK(rtc.lastError() == RTC_OK);  //Cleared by reading it
+
+  //Corrupt reads are caught by the plausibility check
+  Wire.setCorruption(1);
+  t = rtc.getTime();
+  CHECK(t >= 1700000000 && t < 1700000005);
+  CHECK(rtc.lastError() == RTC_ERR_IMPLAUSIBLE);
+  Wire.setCorruption(5);
+  CHECK(rtc.getTime() == 0);
+  CHECK(rtc.lastError() == RTC_ERR_IMPLAUSIBLE);
+  Wire.setCorruption(0);
+
+  //Day of month against the month and leap years
+  const uint8_t feb30[7] = { 0x00, 0x00, 0x12, 0x01, 0x30, 0x02, 0x24 };
+  memcpy(sim.regs, feb30, 7);
+  rtc.setRetries(0);
+  CHECK(rtc.getTime() == 0);
+  CHECK(rtc.lastError() == RTC_ERR_IMPLAUSIBLE);
+  sim.regs[4] = 0x29;
+  CHECK(rtc.getTime() != 0);  //2024 is a leap year
+  sim.regs[6] = 0x23;
+  CHECK(rtc.getTime() == 0);
+  sim.regs[6] = 0x24;
+  rtc.setRetries(2);
+
+  //Read-modify-writes give up when the read fails
+  sim.regs[0x0E] = 0x1C;
+  Wire.setFault(3);
+  rtc.enableAlm1Interrupt();
+  CHECK(sim.regs[0x0E] == 0x1C);
+  CHECK(rtc.lastError() != RTC_OK);
+  sim.regs[0x0F] = 0x88;
+  Wire.setFault(3);
+  rtc.assumeTimeValid();
+  CHECK(sim.regs[0x0F] == 0x88);
+  rtc.lastError();
+
+  //Getters don't decode a failed read, with and without shadow registers
+  CHECK(rtc.setTime(1700000000));
+  rtc.setAgingOffset(5);
+  rtc.setAlarm1Time(1700000100, RTC_ALARM_PER_DAY);
+  CHECK(rtc.timeValid() && rtc.oscillatorEnabled() && rtc.getAgingOffset() == 5 && rtc.getAlarm1Mode() == RTC_ALARM_PER_DAY);
+  for (int shadow = 0; shadow < 2; shadow++) {
+    rtc.enableShadowRegisters(shadow);
+    Wire.setFault(100);
+    CHECK(!rtc.timeValid());
+    CHECK(!rtc.oscillatorEnabled());
+    CHECK(rtc.getAgingOffset() == 0);
+    CHECK(rtc.getAlarm1Mode() == RTC_ALARM_UNKNOWN);
+    CHECK(rtc.getAlarm2Mode() == RTC_ALARM_UNKNOWN);
+    CHECK(rtc.getSQWFreq() == 0);
+    CHECK(!rtc.SQWEnabled());
+    CHECK(!rtc.alm1Tripped());
+    CHECK(!rtc.output32KHzEnabled());
+    Wire.setFault(0);
+    CHECK(rtc.timeValid() && rtc.oscillatorEnabled() && rtc.getAgingOffset() == 5);
+  }
+  rtc.enableShadowRegisters(false);
+  rtc.lastError();
+
+  //Snapshots and asynchronous reads report the error
+  UnixRTCSnapshot snap;
+  Wire.setFault(3);
+  CHECK(!rtc.readSnapshot(snap));
+  CHECK(snap.error == RTC_ERR_NACK_ADDRESS);
+  CHECK(rtc.readSnapshot(snap) && snap.error == RTC_OK);
+  UnixRTCAsync async(rtc);
+  async.read(RTC_READ_TIME, onRead);
+  Wire.setFault(3);
+  gotIt = false;
+  while (async.poll()) {}
+  CHECK(gotIt && got.error == RTC_ERR_NACK_ADDRESS);
+  async.read(RTC_READ_TIME, onRead);
+  gotIt = false;
+  while (async.poll()) {}
+  CHECK(gotIt && got.error == RTC_OK && got.time >= 1700000000);
+  rtc.lastError();
+
+  //Time budget: each failure takes 3ms
+  rtc.setRetries(10);
+  rtc.setTimeBudget(8000);
+  Wire.setFault(20, true, 3000);
+  uint64_t start = simMicros();
+  CHECK(rtc.getTime() == 0);
+  CHECK(simMicros() - start <= 8000);
+  Wire.setFault(0);
+  rtc.setTimeBudget(0);
+  rtc.setRetries(2);
+
+  //Stuck SDA: fails without recovery pins, recovered with them
+  Wire.holdSDA(5);
+  CHECK(rtc.getTime() == 0);
+  CHECK(rtc.lastError() == RTC_ERR_BUS);
+  CHECK(!rtc.recoverBus());
+  rtc.setBusRecovery(SDA, SCL);
+  CHECK(rtc.getTime() >= 1700000000);
+  CHECK(rtc.lastError() == RTC_ERR_BUS);
+  Wire.holdSDA(12);  //More than 9 clocks, the second recovery frees it
+  CHECK(rtc.getTime() >= 1700000000);
+  Wire.holdSDA(30);
+  CHECK(rtc.getTime() == 0);
+  CHECK(!rtc.recoverBus());
+  CHECK(rtc.recoverBus());
+  CHECK(rtc.getTime() > 0);
+
+  SimBusStats before = Wire.stats;
+  rtc.getTime();
+  CHECK(Wire.stats.transactions - before.transactions == 2);  //No overhead once the bus is healthy
+  return SIM_TEST_RESULT();
+}
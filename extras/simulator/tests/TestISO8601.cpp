@@ -0,0 +1,72 @@
+/*
+  formatISO8601()/formatISO8601Ms() against gmtime_r + strftime, parseISO8601() round trips and edge cases.
+*/
+
+#include "UnixRTC.h"
+#include "SimTest.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static uint64_t state = 88172645463325252ULL;
+static uint64_t xorshift() {
+  state ^= state << 13;
+  state ^= state >> 7;
+  state ^= state << 17;
+  return state;
+}
+
+static void reference(uint64_t unix, int ms, int offset, char* out) {
+  time_t t = unix + offset * 60;
+  struct tm tm;
+  gmtime_r(&t, &tm);
+  size_t n = strftime(out, 40, "%Y-%m-%dT%H:%M:%S", &tm);
+  if (ms >= 0) n += sprintf(out + n, ".%03d", ms);
+  if (offset) sprintf(out + n, "%c%02d:%02d", offset < 0 ? '-' : '+', abs(offset) / 60, abs(offset) % 60);
+  else strcpy(out + n, "Z");
+}
+
+int main() {
+  char ours[RTC_ISO8601_LENGTH], expect[64];
+  uint32_t bad = 0;
+  for (int i = 0; i < 500000; i++) {
+    uint64_t u = 946684800ULL + xorshift() % (7258118400ULL - 946684800ULL);
+    int ms = (i & 1) ? (int)(xorshift() % 1000) : -1;
+    int offset = (i % 3) ? (int)(xorshift() % 2879) - 1439 : 0;
+    uint8_t n = ms >= 0 ? UnixRTC::formatISO8601Ms(u * 1000 + ms, ours, sizeof ours, offset) : UnixRTC::formatISO8601(u, ours, sizeof ours, offset);
+    uint64_t local = u + offset * 60LL;
+    if (local < 946684800ULL || local >= 7258118400ULL) {  //Local time outside Y2000-Y2199
+      bad += n != 0;
+      continue;
+    }
+    reference(u, ms, offset, expect);
+    if (n != strlen(expect) || strcmp(ours, expect)) {
+      if (bad++ < 5) printf("%s, expected %s\n", ours, expect);
+      continue;
+    }
+    uint64_t parsed;
+    uint16_t parsedMs;
+    if (!UnixRTC::parseISO8601(ours, parsed, &parsedMs) || parsed != u || (ms >= 0 && parsedMs != ms)) {
+      if (bad++ < 5) printf("parse %s\n", ours);
+    }
+  }
+  CHECK(bad == 0);
+
+  uint64_t p;
+  uint16_t m;
+  CHECK(UnixRTC::parseISO8601("2024-02-29 12:00:00", p) && p == 1709208000ULL);
+  CHECK(!UnixRTC::parseISO8601("2023-02-29T12:00:00Z", p));
+  CHECK(!UnixRTC::parseISO8601("2100-02-29T12:00:00Z", p));
+  CHECK(!UnixRTC::parseISO8601("1999-12-31T23:59:59Z", p));
+  CHECK(UnixRTC::parseISO8601("2000-01-01T01:00:00+01:00", p) && p == 946684800ULL);
+  CHECK(!UnixRTC::parseISO8601("2000-01-01T00:59:59+01:00", p));
+  CHECK(UnixRTC::parseISO8601("2024-05-01T12:00:00.5-0230", p, &m) && m == 500 && p == 1714564800ULL + 9000);
+  CHECK(!UnixRTC::parseISO8601("2024-05-01T12:00:00.Z", p));
+  CHECK(!UnixRTC::parseISO8601("2024-05-01T12:00:00Zx", p));
+  CHECK(!UnixRTC::parseISO8601("2024-05-01T24:00:00Z", p));
+  CHECK(UnixRTC::parseISO8601("2024-05-01t12:00:00.123456z", p, &m) && m == 123);
+  CHECK(UnixRTC::formatISO8601(1714564800ULL, ours, 20) == 0);  //No room for the terminator
+  CHECK(UnixRTC::formatISO8601(1714564800ULL, ours, 21) == 20);
+  CHECK(!strcmp(ours, "2024-05-01T12:00:00Z"));
+  return SIM_TEST_RESULT();
+}
@@ -0,0 +1,122 @@
+/*
+  Incremental reads: within a minute getTime() reads the seconds register alone. Checked against
+  full reads from a second UnixRTC, across setTime(), the age limit, sleeps and alarm wake ups, Y2100
+  and temperature sampling.
+*/
+
+#include "UnixRTCScheduler.h"
+#include "UnixRTCTempHistory.h"
+#include "SimTest.h"
+#include <stdlib.h>
+
+int main() {
+  SimFixture sim;
+  UnixRTC& rtc = sim.rtc;
+  UnixRTC full;  //Reference, always reads every register
+  full.begin();
+  CHECK(!rtc.incrementalReadsEnabled());
+  rtc.setTime(1700000000);
+
+  //Bus time at 1 Hz for an hour
+  SimBusStats before = Wire.stats;
+  for (int i = 0; i < 3600; i++) {
+    delay(1000);
+    rtc.getTime();
+  }
+  uint64_t plain = Wire.stats.busMicros - before.busMicros;
+  rtc.enableIncrementalReads();
+  CHECK(rtc.incrementalReadsEnabled());
+  before = Wire.stats;
+  for (int i = 0; i < 3600; i++) {
+    delay(1000);
+    rtc.getTime();
+  }
+  uint64_t incremental = Wire.stats.busMicros - before.busMicros;
+  printf("bus time per getTime(): %.0f us full, %.0f us incremental\n", plain / 3600.0, incremental / 3600.0);
+  CHECK(incremental * 2 < plain);
+
+  //Random gaps, mostly within the minute
+  srand(25);
+  uint32_t bad = 0;
+  for (int i = 0; i < 5000; i++) {
+    int r = rand() % 100;
+    uint32_t gap = r < 60 ? rand() % 1500 : r < 90 ? rand() % 62000 : rand() % 200000;
+    delay(gap);
+    uint64_t low = full.getTime();  //Bracketed, the second may tick between reads
+    uint64_t t = rtc.getTime();
+    UnixRTCDateTime dt;
+    rtc.getDateTime(dt);
+    uint64_t high = full.getTime();
+    uint64_t fromStruct = UnixRTC::fromDateTime(dt);
+    if (t < low || t > high || fromStruct < t || fromStruct > high) {
+      if (bad++ < 5) printf("gap %u ms: %llu, full reads %llu-%llu\n", gap, (unsigned long long)t, (unsigned long long)low, (unsigned long long)high);
+    }
+  }
+  CHECK(bad == 0);
+
+  delay(500);
+  rtc.getTime();
+  CHECK(rtc.setTime(1800000030));  //Drops the cached minute
+  CHECK(rtc.getTime() == 1800000030);
+  full.setTime(1900000000);  //Another writer is only noticed by the seconds going back or the age limit
+  delay(UNIXRTC_INCREMENTAL_MS);
+  CHECK(rtc.getTime() == full.getTime());
+
+  //A sleep that stops millis(): the RTC moves on behind the cached minute, emulated by moving its minutes
+  CHECK(rtc.setTime(1700000000));  //22:13:20
+  rtc.getTime();
+  sim.regs[1] += 2;
+  CHECK(rtc.getTime() + 120 == full.getTime());  //Stale, the seconds didn't go back
+  rtc.invalidateIncrementalReads();
+  CHECK(rtc.getTime() == full.getTime());
+
+  //Waking on an alarm drops the cached minute, through UnixRTC and the scheduler
+  sim.connectIntPin(4);
+  CHECK(rtc.setTime(1700000000));
+  CHECK(rtc.setAlarm1Time(1700000121));
+  rtc.attachAlarmInterrupt(4, nullptr, RTC_ALM1);
+  rtc.getTime();
+  sim.regs[1] += 2;
+  delay(1000);
+  CHECK(rtc.service() == RTC_ALM1);
+  CHECK(rtc.getTime() == full.getTime());
+  rtc.detachAlarmInterrupt();
+  UnixRTCScheduler scheduler(rtc);
+  scheduler.begin();
+  CHECK(rtc.setTime(1700000000));
+  CHECK(scheduler.schedule(1700000121, [](uint64_t, void*) {}) >= 0);
+  rtc.getTime();
+  sim.regs[1] += 2;
+  delay(1000);
+  CHECK(scheduler.service());
+  CHECK(rtc.getTime() == full.getTime());
+
+  //Crossing the chip's Feb 29th 2100, read every 700ms
+  CHECK(rtc.setTime(4107542400ULL - 40));
+  uint64_t last = 0;
+  bool monotonic = true;
+  for (int i = 0; i < 200; i++) {
+    delay(700);
+    uint64_t t = rtc.getTime();
+    if (last && (t < last || t > last + 1)) monotonic = false;
+    last = t;
+  }
+  CHECK(monotonic);
+  CHECK(last == full.getTime());
+  UnixRTCDateTime dt;
+  CHECK(rtc.getDateTime(dt));
+  CHECK(dt.month == 3 && dt.day == 1 && dt.year == 100 && dt.dayOfWeek == 1);
+  CHECK((sim.regs[2] & 0x40) && sim.regs[4] == 0x01 && sim.regs[5] == 0x83);
+
+  //Temperature history keeps its sampling
+  UnixRTCTempHistory history;
+  rtc.trackTemp(&history);
+  for (int i = 0; i < 600; i++) {
+    delay(1000);
+    rtc.getTime();
+  }
+  CHECK(history.count() >= 9);
+  rtc.disableIncrementalReads();
+  CHECK(rtc.getTime() == full.getTime());
+  return SIM_TEST_RESULT();
+}
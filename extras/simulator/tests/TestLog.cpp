@@ -0,0 +1,187 @@
+/*
+  UnixRTCLog on the simulated AT24C32: records survive a reboot, the ring wraps with even wear,
+  a torn page is skipped, and a failed commit is reported and retried.
+*/
+
+#include "AT24C32Sim.h"
+#include "UnixRTCLog.h"
+#include "SimTest.h"
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+struct Record {
+  uint64_t time;
+  uint8_t event;
+  uint8_t length;
+  uint8_t data[UNIXRTC_LOG_DATA];
+};
+
+static std::vector<Record> readAll(UnixRTCLog& log) {
+  std::vector<Record> records;
+  UnixRTCLogRecord r;
+  log.beginRead();
+  while (log.readNext(r)) {
+    Record x;
+    x.time = r.time;
+    x.event = r.event;
+    x.length = r.length;
+    memcpy(x.data, r.data, r.length);
+    records.push_back(x);
+  }
+  return records;
+}
+
+static bool same(const Record& a, const Record& b) {
+  return a.time == b.time && a.event == b.event && a.length == b.length && !memcmp(a.data, b.data, a.length);
+}
+
+static bool endsWith(const std::vector<Record>& got, const std::vector<Record>& expect) {  //got is the tail of expect
+  if (got.size() > expect.size()) return false;
+  size_t offset = expect.size() - got.size();
+  for (size_t i = 0; i < got.size(); i++) {
+    if (!same(got[i], expect[offset + i])) return false;
+  }
+  return true;
+}
+
+int main() {
+  SimFixture sim(1700000000);
+  UnixRTC& rtc = sim.rtc;
+  AT24C32Sim eeprom;
+  srand(1);
+
+  //Records with gaps (up to 3 byte offsets and a new page base), read back before and after a reboot
+  std::vector<Record> expect;
+  {
+    UnixRTCLog log(rtc);
+    CHECK(log.begin());
+    CHECK(log.pagesUsed() == 0 && readAll(log).empty());
+    uint64_t t = 1700000000;
+    uint32_t cycles = eeprom.writeCycles;
+    for (int i = 0; i < 300; i++) {
+      Record r;
+      t += rand() % 50;
+      if (rand() % 50 == 0) t += 3000000;
+      r.time = t;
+      r.event = rand();
+      r.length = rand() % 6;
+      for (int k = 0; k < r.length; k++) r.data[k] = rand();
+      CHECK(log.log(r.time, r.event, r.data, r.length));
+      expect.push_back(r);
+    }
+    CHECK(eeprom.writeCycles - cycles < log.pagesUsed() * 2);  //About a write per page
+    std::vector<Record> got = readAll(log);
+    CHECK(got.size() == expect.size() && endsWith(got, expect));
+    CHECK(log.flush());
+  }
+  {
+    UnixRTCLog log(rtc);
+    CHECK(log.begin());
+    std::vector<Record> got = readAll(log);
+    CHECK(got.size() == expect.size() && endsWith(got, expect));
+    Record r = expect.back();
+    r.time += 5;
+    r.event = 7;
+    r.length = 0;
+    CHECK(log.log(r.time, r.event));
+    expect.push_back(r);
+    r.time -= 100;  //Going back in time
+    r.event = 8;
+    CHECK(log.log(r.time, r.event));
+    expect.push_back(r);
+    got = readAll(log);
+    CHECK(got.size() == expect.size() && endsWith(got, expect));
+  }
+  {
+    UnixRTCLog log(rtc);  //The two unflushed records are lost
+    CHECK(log.begin());
+    std::vector<Record> got = readAll(log);
+    CHECK(got.size() == expect.size() - 2 || got.size() == expect.size() - 1);
+    CHECK(log.clear());
+    CHECK(log.pagesUsed() == 0 && readAll(log).empty());
+    UnixRTCLog after(rtc);
+    CHECK(after.begin());
+    CHECK(after.pagesUsed() == 0);
+  }
+
+  //Wrapping the ring many times over, sequence numbers included
+  {
+    UnixRTCLog log(rtc);
+    CHECK(log.begin());
+    uint64_t t = 1800000000;
+    expect.clear();
+    for (uint32_t i = 0; i < 280000; i++) {
+      Record r;
+      r.time = ++t;
+      r.event = i;
+      r.length = 4;
+      memcpy(r.data, &i, 4);
+      if (!log.log(r.time, r.event, r.data, r.length)) {
+        FAIL("log() failed at record %u", i);
+        break;
+      }
+      expect.push_back(r);
+    }
+    CHECK(log.pagesUsed() == 128);
+    std::vector<Record> got = readAll(log);
+    CHECK(got.size() > 300 && endsWith(got, expect));
+    uint32_t least = ~0u, most = 0;
+    for (int p = 0; p < 128; p++) {
+      if (eeprom.pageWrites[p] < least) least = eeprom.pageWrites[p];
+      if (eeprom.pageWrites[p] > most) most = eeprom.pageWrites[p];
+    }
+    CHECK(most - least <= 8);
+    CHECK(log.flush());
+    UnixRTCLog after(rtc);
+    CHECK(after.begin());
+    std::vector<Record> rebooted = readAll(after);
+    CHECK(rebooted.size() >= got.size() && endsWith(rebooted, expect));
+  }
+
+  //Torn rewrite: the CRC of a page written again after a flush() never lands
+  {
+    UnixRTCLog log(rtc);
+    CHECK(log.begin() && log.clear());
+    uint64_t t = 1900000000;
+    CHECK(log.log(t, 1, (const uint8_t*)"abcd", 4));
+    CHECK(log.log(t + 1, 1, (const uint8_t*)"abcd", 4));
+    CHECK(log.flush());
+    delay(20);
+    CHECK(log.log(t + 2, 2, (const uint8_t*)"ab", 2));
+    static uint8_t before[4096];
+    memcpy(before, eeprom.memory, sizeof before);
+    CHECK(log.flush());
+    int torn = -1;
+    for (int p = 0; p < 128; p++) {
+      if (memcmp(before + p * 32, eeprom.memory + p * 32, 32)) torn = p;
+    }
+    CHECK(torn >= 0);
+    if (torn >= 0) memcpy(eeprom.memory + torn * 32 + 30, before + torn * 32 + 30, 2);  //Old CRC
+    UnixRTCLog after(rtc);
+    CHECK(after.begin());
+    CHECK(readAll(after).empty());  //Page lost, as documented
+    CHECK(after.log(t + 3, 3));
+    CHECK(after.flush());
+    UnixRTCLog again(rtc);
+    CHECK(again.begin());
+    std::vector<Record> got = readAll(again);
+    CHECK(got.size() == 1 && got.back().event == 3);
+
+    //A failed commit is reported and retried by the next flush()
+    CHECK(again.log(t + 4, 4));
+    Wire.setFault(1);
+    CHECK(!again.flush());
+    CHECK(again.flush());
+    UnixRTCLog last(rtc);
+    CHECK(last.begin());
+    got = readAll(last);
+    CHECK(got.size() == 2 && got.back().event == 4);
+
+    //Reading the page being filled stays off the bus
+    SimBusStats bus = Wire.stats;
+    readAll(last);
+    CHECK(Wire.stats.transactions == bus.transactions);
+  }
+  return SIM_TEST_RESULT();
+}
@@ -0,0 +1,46 @@
+/*
+  EOSC: the oscillator keeps running on battery after setTime(), enableOscillator() and the Config
+  builder, stops on battery once disabled, and oscillatorEnabled() and snapshots report it that way.
+*/
+
+#include "SimTest.h"
+
+static bool survivesPowerLoss(SimFixture& sim) {  //5s on VBAT, true if the time kept counting
+  uint64_t before = sim.rtc.getTime();
+  sim.setVcc(false);
+  delay(5000);
+  sim.setVcc(true);
+  uint64_t after = sim.rtc.getTime();
+  return sim.rtc.timeValid() && after >= before + 5 && after <= before + 6;
+}
+
+int main() {
+  SimFixture sim(1777777777);
+  UnixRTC& rtc = sim.rtc;
+  UnixRTCSnapshot snap;
+  CHECK(!(sim.regs[0x0E] & 0x80));  //setTime() clears EOSC
+  CHECK(rtc.oscillatorEnabled());
+  rtc.readSnapshot(snap);
+  CHECK(snap.oscillatorEnabled);
+  CHECK(survivesPowerLoss(sim));
+
+  rtc.disableOscillator();
+  CHECK(sim.regs[0x0E] & 0x80);
+  CHECK(!rtc.oscillatorEnabled());
+  rtc.readSnapshot(snap);
+  CHECK(!snap.oscillatorEnabled);
+  CHECK(!survivesPowerLoss(sim));  //Stopped on VBAT, OSF set
+  CHECK(!rtc.timeValid());
+  CHECK(rtc.setTime(1777777777));  //Restarts it
+  CHECK(rtc.timeValid() && rtc.oscillatorEnabled());
+  CHECK(survivesPowerLoss(sim));
+
+  rtc.disableOscillator();
+  rtc.enableOscillator();
+  CHECK(rtc.oscillatorEnabled() && survivesPowerLoss(sim));
+  CHECK(rtc.beginConfig().oscillator(false).commit());
+  CHECK(!rtc.oscillatorEnabled() && (sim.regs[0x0E] & 0x80));
+  CHECK(rtc.beginConfig().oscillator(true).commit());
+  CHECK(rtc.oscillatorEnabled() && survivesPowerLoss(sim));
+  return SIM_TEST_RESULT();
+}
@@ -0,0 +1,117 @@
+/*
+  UnixRTCPublisher: refresh() and error reporting, then readers checking that every state they copy
+  is one the writer published whole while it publishes as fast as it can: a timer signal handler
+  interrupting the writer (an ISR on the same core), then three reader threads.
+*/
+
+#include "UnixRTCPublisher.h"
+#include "SimTest.h"
+#include <signal.h>
+#include <string.h>
+#include <sys/time.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+static const uint64_t SYNTHETIC = 2000000000ULL;  //Published times from here on encode every other field
+
+static UnixRTCPublisher* publisher;
+static std::atomic<bool> stop(false);
+static std::atomic<long> reads(0), torn(0), backwards(0);
+
+static void check(const UnixRTCState& s, uint64_t& last) {
+  if (s.time < SYNTHETIC) return;
+  uint64_t k = s.time - SYNTHETIC;
+  if (s.temp != (int16_t)(k * 7) || s.control != (uint8_t)k || s.status != (uint8_t)(k >> 8) || s.agingOffset != (int8_t)(k * 3)) torn++;
+  if (s.time < last) backwards++;
+  last = s.time;
+}
+
+static void reader() {
+  long n = 0;
+  uint64_t last = 0;
+  while (!stop.load(std::memory_order_relaxed)) {
+    UnixRTCState s;
+    publisher->read(s);
+    check(s, last);
+    n++;
+  }
+  reads += n;
+}
+
+static uint64_t isrLast = 0;
+static void isr(int) {  //Interrupts the writer wherever it is, must find a stable copy without waiting
+  UnixRTCState s;
+  publisher->read(s);
+  check(s, isrLast);
+  reads++;
+}
+
+static uint64_t publishFor(int ms, uint64_t k) {  //Publishes synthetic snapshots, returns the last k
+  UnixRTCSnapshot snapshot;
+  memset(&snapshot, 0, sizeof(snapshot));
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  while (std::chrono::steady_clock::now() - start < std::chrono::milliseconds(ms)) {
+    k++;
+    snapshot.time = SYNTHETIC + k;
+    snapshot.temp = k * 7;
+    snapshot.regs[0x0E] = k;
+    snapshot.regs[0x0F] = k >> 8;
+    snapshot.agingOffset = k * 3;
+    publisher->publish(snapshot);
+  }
+  return k;
+}
+
+int main() {
+  SimFixture sim(1700000000);
+  UnixRTC& rtc = sim.rtc;
+  UnixRTCPublisher pub(rtc);
+  publisher = &pub;
+  CHECK(pub.getTime() == 0);
+  UnixRTCSequence generation = pub.generation();
+  CHECK(pub.refresh());
+  CHECK(pub.generation() != generation);
+  UnixRTCState state;
+  pub.read(state);
+  CHECK(state.time >= 1700000000 && state.time < 1700000003 && state.error == RTC_OK);
+  CHECK(pub.timeValid());
+  delay(5000);
+  CHECK(pub.getTime() >= state.time + 5 && pub.getTime() <= state.time + 6);  //Moved on without the bus
+  Wire.setFault(10);
+  rtc.setRetries(0);
+  CHECK(!pub.refresh());
+  pub.read(state);
+  CHECK(state.error != RTC_OK && state.time >= 1700000000);  //Last good values kept
+  Wire.setFault(0);
+  CHECK(pub.refresh());
+  pub.read(state);
+  CHECK(state.error == RTC_OK);
+
+  //Same core: a 20us timer signal reads in the middle of publishes
+  signal(SIGALRM, isr);
+  struct itimerval timer = { { 0, 20 }, { 0, 20 } };
+  setitimer(ITIMER_REAL, &timer, nullptr);
+  uint64_t k = publishFor(1000, 0);
+  struct itimerval off = { { 0, 0 }, { 0, 0 } };
+  setitimer(ITIMER_REAL, &off, nullptr);
+  signal(SIGALRM, SIG_DFL);
+  printf("%llu publishes, %ld interrupting reads\n", (unsigned long long)k, reads.load());
+  CHECK(torn == 0 && backwards == 0);
+  CHECK(reads > 1000);
+
+  //Other cores (when there are any): three reader threads
+  reads = 0;
+  std::vector<std::thread> readers;
+  for (int r = 0; r < 3; r++) readers.push_back(std::thread(reader));
+  k = publishFor(2000, k);
+  stop = true;
+  for (size_t r = 0; r < readers.size(); r++) readers[r].join();
+  printf("%llu publishes, %ld reads from threads\n", (unsigned long long)k, reads.load());
+  CHECK(torn == 0 && backwards == 0);
+  CHECK(reads > 1000);
+  pub.read(state);
+  CHECK(state.time == SYNTHETIC + k);
+  return SIM_TEST_RESULT();
+}
@@ -0,0 +1,81 @@
+/*
+  UnixRTCScheduler over 100 days: one-shot events (one beyond Alarm 1's reach), a cancelled one
+  and an hourly one, all run on time from the INT pin. Between wake ups the RTC is moved to
+  just before the armed alarm, as if the MCU slept through. scheduleIn() with the bus failing.
+*/
+
+#include "UnixRTCScheduler.h"
+#include "SimTest.h"
+#include <stdlib.h>
+#include <algorithm>
+#include <vector>
+
+static UnixRTC rtc;
+static UnixRTCScheduler sched(rtc);
+static std::vector<std::pair<uint64_t, uint64_t> > fired;  //Deadline, time it ran
+
+static void onEvent(uint64_t deadline, void*) {
+  fired.push_back(std::make_pair(deadline, rtc.getTime()));
+}
+
+int main() {
+  const uint64_t t0 = 1700000000ULL, end = t0 + 100ULL * 86400;
+  SimFixture sim(rtc, t0);
+  sim.connectIntPin(3);
+  sched.begin();
+  CHECK(!rtc.SQWEnabled() && rtc.alm1InterrptEnabled());
+
+  srand(1);
+  std::vector<uint64_t> oneShot;
+  for (int i = 0; i < 12; i++) {
+    oneShot.push_back(t0 + 10 + rand() % 200000);
+    CHECK(sched.schedule(oneShot.back(), onEvent) >= 0);
+  }
+  oneShot.push_back(t0 + 90ULL * 86400);  //Needs intermediate wake ups
+  CHECK(sched.schedule(oneShot.back(), onEvent) >= 0);
+  int8_t id = sched.schedule(t0 + 50, onEvent);
+  CHECK(sched.cancel(id));
+  CHECK(!sched.cancel(id));
+  int8_t hourly = sched.scheduleIn(3600, onEvent, nullptr, 3600);
+  CHECK(hourly >= 0);
+
+  uint32_t wakeUps = 0;
+  for (uint64_t now = rtc.getTime(); now < end; now = rtc.getTime()) {
+    uint64_t armed = rtc.getAlarm1Time();
+    if (armed > now + 2) rtc.setTime(std::min(armed, end) - 2);
+    simAdvance(1000000);
+    if (digitalRead(3) == LOW) {
+      wakeUps++;
+      sched.service();
+      CHECK(digitalRead(3) == HIGH);  //Flag cleared, next alarm armed
+    }
+  }
+  CHECK(sched.cancel(hourly));
+  CHECK(sched.pending() == 0);
+
+  //scheduleIn() refuses a time it couldn't read, and doesn't trip over an error left from before
+  Wire.setFault(255);
+  CHECK(sched.scheduleIn(60, onEvent) == -1);
+  Wire.setFault(0);
+  CHECK(sched.pending() == 0 && rtc.lastError() != RTC_OK);
+  Wire.setFault(255);
+  rtc.getTime();
+  Wire.setFault(0);
+  id = sched.scheduleIn(60, onEvent);
+  CHECK(id >= 0 && sched.nextDeadline() >= end + 60);
+  CHECK(rtc.lastError() != RTC_OK);  //Kept for the caller
+  CHECK(sched.cancel(id));
+
+  for (size_t i = 0; i < fired.size(); i++) {
+    if (fired[i].second != fired[i].first && fired[i].second != fired[i].first + 1) FAIL("event for %llu ran at %llu", (unsigned long long)fired[i].first, (unsigned long long)fired[i].second);
+  }
+  for (size_t i = 0; i < oneShot.size(); i++) {
+    bool found = false;
+    for (size_t k = 0; k < fired.size(); k++) found |= fired[k].first == oneShot[i];
+    if (!found) FAIL("event for %llu never ran", (unsigned long long)oneShot[i]);
+  }
+  CHECK(fired.size() == 13 + 2400);
+  CHECK(wakeUps <= fired.size() + 4);  //Only the intermediate wake ups run nothing
+  printf("%zu events, %u wake ups\n", fired.size(), wakeUps);
+  return SIM_TEST_RESULT();
+}
@@ -0,0 +1,98 @@
+/*
+  setTime()/setTimeAt()/setTimeMs(): sub-second phase against a reference clock, at either bus speed
+  and with stale references, and the seconds-only write landing in the right second for any lead.
+*/
+
+#include "SimTest.h"
+#include <stdlib.h>
+
+static const uint64_t EPOCH_US = 1700000000ULL * 1000000 + 123456;  //Reference time is EPOCH_US + simMicros()
+
+static SimFixture* sim;
+
+static uint64_t referenceMs() {
+  return (EPOCH_US + simMicros()) / 1000;
+}
+
+static int64_t phaseError() {  //RTC minus reference, us
+  uint32_t phase;
+  uint64_t rtcUs;
+  do {
+    phase = sim->subSecondMicros();
+    rtcUs = sim->rtc.getTime() * 1000000ULL + sim->subSecondMicros();
+  } while (sim->subSecondMicros() < phase);  //Ticked during the read
+  return (int64_t)(rtcUs - (EPOCH_US + simMicros()));
+}
+
+int main() {
+  SimFixture s;
+  UnixRTC& r = s.rtc;
+  sim = &s;
+  srand(3);
+
+  int64_t worstSetTime = 0, worstSetTimeAt = 0;
+  for (int i = 0; i < 50; i++) {
+    delayMicroseconds(rand() % 1000000);
+    CHECK(r.setTime(referenceMs() / 1000));
+    int64_t e = phaseError();
+    if (llabs(e) > llabs(worstSetTime)) worstSetTime = e;
+    delayMicroseconds(rand() % 1000000);
+    uint32_t reference = micros();
+    uint64_t ms = referenceMs();
+    uint32_t start = micros();
+    CHECK(r.setTimeAt(ms, reference));
+    CHECK(micros() - start < 1100000);
+    e = phaseError();
+    if (llabs(e) > llabs(worstSetTimeAt)) worstSetTimeAt = e;
+  }
+  printf("worst phase error: setTime %lld us, setTimeAt %lld us\n", (long long)worstSetTime, (long long)worstSetTimeAt);
+  CHECK(llabs(worstSetTime) > 100000);  //Truncates to the second
+  CHECK(llabs(worstSetTimeAt) < 2000);
+
+  Wire.setClock(400000);
+  delayMicroseconds(333333);
+  CHECK(r.setTimeMs(referenceMs()));
+  CHECK(llabs(phaseError()) < 2000);
+  Wire.setClock(100000);
+
+  uint32_t reference = micros();  //Taken 300ms before the call
+  uint64_t ms = referenceMs();
+  delay(300);
+  CHECK(r.setTimeAt(ms, reference));
+  CHECK(llabs(phaseError()) < 2000);
+  CHECK(r.timeValid());
+  CHECK(!r.setTimeMs(100));  //Before Y2000
+
+  //Leads around a whole second: the seconds-only write must land before the RTC ticks on its own
+  const uint64_t unix = 1700000039ULL;  //:59, so a late write would show as a wrong minute
+  for (int lead = 980; lead <= 1020; lead++) {
+    reference = micros();
+    CHECK(r.setTimeAt(unix * 1000 - lead, reference));
+    uint64_t expect = unix + (micros() - reference - lead * 1000 + 999999) / 1000000;
+    uint64_t got = r.getTime();
+    if (got + 1 < expect || got > expect + 1) FAIL("lead %d ms: %llu, expected %llu", lead, (unsigned long long)got, (unsigned long long)expect);
+    delay(rand() % 1000);
+  }
+
+  //Phase measured at the RTC's next tick, for random references
+  int32_t worst = 0;
+  for (int i = 0; i < 200; i++) {
+    reference = micros();
+    ms = 1700000000000ULL + rand() % 100000000;
+    CHECK(r.setTimeAt(ms, reference));
+    uint64_t t0 = r.getTime();
+    while (r.getTime() == t0) {}
+    uint32_t edge = micros();  //To bus resolution
+    int64_t referenceAtEdge = (int64_t)ms * 1000 + (int32_t)(edge - reference);
+    int32_t error = (int32_t)((int64_t)(t0 + 1) * 1000000 - referenceAtEdge);
+    if (abs(error) > abs(worst)) worst = error;
+  }
+  printf("worst phase error at the next tick: %d us\n", worst);
+  CHECK(abs(worst) < 2000);
+
+  Wire.setFault(255);
+  CHECK(!r.setTimeMs(1700000000000ULL));
+  CHECK(r.lastError() != RTC_OK);
+  Wire.setFault(0);
+  return SIM_TEST_RESULT();
+}
@@ -0,0 +1,60 @@
+/*
+  Software clock: the SQW disciplined one stays within a few ms of the chip without bus traffic,
+  the polled one is monotonic and only touches the bus to resynchronise.
+*/
+
+#include "SimTest.h"
+
+static UnixRTC rtc;
+static void onSQW() {
+  rtc.sqwEdge();
+}
+
+int main() {
+  SimFixture sim(rtc, 1777777777);
+  delay(300);
+  sim.connectIntPin(2);
+  pinMode(2, INPUT_PULLUP);
+  attachInterrupt(digitalPinToInterrupt(2), onSQW, FALLING);
+  CHECK(rtc.beginSoftClock() == RTC_SOFT_SQW);
+
+  uint64_t last = 0;
+  uint32_t bad = 0;
+  for (int i = 0; i < 5000; i++) {
+    uint32_t before = Wire.stats.transactions;
+    uint64_t us = rtc.getTimeUs();
+    if (Wire.stats.transactions != before) bad++;
+    uint32_t phase = sim.subSecondMicros();
+    uint64_t truth = rtc.getTime() * 1000000ULL + sim.subSecondMicros();
+    if (sim.subSecondMicros() < phase) continue;  //Ticked during the read
+    long long error = (long long)us - (long long)truth;
+    if (error < -3000 || error > 3000) bad++;
+    if (us < last) bad++;
+    last = us;
+    delayMicroseconds(777);
+  }
+  CHECK(bad == 0);
+  CHECK(rtc.setTime(1800000000));  //Restarts the countdown, the software clock follows
+  delay(1500);
+  uint64_t ms = rtc.getTimeMs();
+  CHECK(ms >= 1800000001500ULL - 3 && ms <= 1800000001500ULL + 3);
+
+  detachInterrupt(2);
+  CHECK(rtc.beginSoftClock(false) == RTC_SOFT_POLLED);
+  last = 0;
+  bad = 0;
+  uint32_t before = Wire.stats.transactions;
+  for (int i = 0; i < 20000; i++) {
+    ms = rtc.getTimeMs();
+    if (ms < last) bad++;
+    last = ms;
+    delayMicroseconds(500);
+  }
+  CHECK(bad == 0);
+  uint32_t used = Wire.stats.transactions - before;
+  uint64_t seconds = rtc.getTime();
+  printf("polled: %u transactions over 10s\n", used);
+  CHECK(used <= 2 * 11);  //One read a second
+  CHECK(last / 1000 + 1 >= seconds && last / 1000 <= seconds);
+  return SIM_TEST_RESULT();
+}
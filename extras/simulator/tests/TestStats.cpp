@@ -0,0 +1,53 @@
+/*
+  UNIXRTC_INSTRUMENT counters: per call transactions, bytes, retries and errors, and the text and
+  binary dumps. Built against an instrumented copy of the library (see the Makefile).
+*/
+
+#include "SimTest.h"
+#include <string>
+
+struct Capture : Print {
+  std::string text;
+  size_t write(uint8_t c) override {
+    text += (char)c;
+    return 1;
+  }
+};
+
+int main() {
+  SimFixture sim;
+  UnixRTC& rtc = sim.rtc;
+  UnixRTC::resetStats();
+  rtc.setTime(1700000000);
+  for (int i = 0; i < 10; i++) rtc.getTime();
+  const UnixRTCCallStats* s = UnixRTC::getStats("getTime");
+  CHECK(s && s->calls == 10);
+  if (!s) return SIM_TEST_RESULT();
+  CHECK(s->transactions == 20 && s->bytesWritten == 10 && s->bytesRead == 70);
+  CHECK(s->histogram[3] == 10);  //940us at 100kHz, 512-1024us
+  Wire.setFault(1);
+  rtc.getTime();
+  CHECK(s->retries == 1 && s->errors == 0);
+  Wire.setFault(5);
+  rtc.getTime();
+  CHECK(s->errors == 1);
+  Wire.setFault(0);
+  rtc.setAlarm1Time(1700000100);  //Its getTime() is nested, counted towards setAlarm1Time
+  CHECK(s->calls == 12);
+  CHECK(UnixRTC::getStats("setAlarm1Time") && UnixRTC::getStats("setAlarm1Time")->calls == 1);
+  CHECK(UnixRTC::getStats("nothing") == nullptr);
+
+  Capture text, binary;
+  UnixRTC::dumpStats(text);
+  UnixRTC::dumpStats(binary, true);
+  CHECK(text.text.find("\ngetTime 12 ") != std::string::npos);
+  CHECK(binary.text.compare(0, 4, std::string("URS\x01", 4)) == 0 && (uint8_t)binary.text[4] == UNIXRTC_STATS_BINS);
+  uint8_t slots = binary.text[5];
+  size_t expected = 6;
+  for (size_t at = 6; slots--; at = expected) expected += 1 + (uint8_t)binary.text[at] + 4 * 4 + 2 * 2 + 4 + UNIXRTC_STATS_BINS * 2;
+  CHECK(binary.text.size() == expected);
+
+  UnixRTC::resetStats();
+  CHECK(UnixRTC::getStats("getTime") == nullptr);
+  return SIM_TEST_RESULT();
+}
@@ -0,0 +1,83 @@
+/*
+  Temperature: non-blocking conversions polled with short reads, the reading's age, timeouts
+  that keep the previous reading, and the history sampled from getTime() at a bounded bus cost.
+*/
+
+#include "UnixRTCTempHistory.h"
+#include "SimTest.h"
+#include <math.h>
+
+int main() {
+  SimFixture sim(1777777777);
+  UnixRTC& rtc = sim.rtc;
+
+  sim.setTemperature(21.75);
+  CHECK(rtc.startTempConversion());
+  CHECK(!rtc.startTempConversion());  //Already pending
+  uint8_t state;
+  uint32_t polls = 0, maxTransactions = 0;
+  do {
+    uint32_t before = Wire.stats.transactions;
+    state = rtc.tempReady();
+    if (Wire.stats.transactions - before > maxTransactions) maxTransactions = Wire.stats.transactions - before;
+    polls++;
+    delay(10);
+  } while (state == RTC_TEMP_PENDING);
+  CHECK(state == RTC_TEMP_READY);
+  CHECK(maxTransactions <= 2);
+  CHECK(polls >= 10 && polls <= 30);  //About 200ms
+  uint32_t age;
+  CHECK(rtc.readTemp(&age) == 87);
+  delay(500);
+  rtc.readTemp(&age);
+  CHECK(age >= 500 && age < 600);
+
+  sim.conversionMicros = 5000000;  //Longer than the timeout
+  sim.setTemperature(30);
+  CHECK(rtc.startTempConversion(200));
+  while ((state = rtc.tempReady()) == RTC_TEMP_PENDING) delay(20);
+  CHECK(state == RTC_TEMP_TIMEOUT);
+  CHECK(rtc.readTemp() == 87);  //Previous value kept
+  delay(5000);
+  sim.conversionMicros = 125000;
+  CHECK(rtc.getTempInt(true) == 120);
+
+  //History: a sample a minute, piggybacked on getTime()
+  UnixRTCTempHistory history;
+  rtc.trackTemp(&history);
+  SimBusStats before = Wire.stats;
+  const uint32_t calls = 3600;
+  for (uint32_t s = 0; s < calls; s++) {
+    sim.setTemperature(20 + 10 * sin(s / 600.0));
+    delay(1000);
+    rtc.getTime();
+  }
+  uint32_t transactions = Wire.stats.transactions - before.transactions;
+  uint32_t written = Wire.stats.bytesWritten - before.bytesWritten;
+  uint32_t read = Wire.stats.bytesRead - before.bytesRead;
+  CHECK(transactions == 2 * calls && written == calls);  //Samples come with the time read
+  CHECK(history.count() >= 55 && history.count() <= 57);
+  CHECK(read == calls * 7 + history.count() * 12);
+  CHECK(history.size() == UNIXRTC_TEMP_HISTORY);
+  CHECK(history.lowest() >= 10 * 4 - 1 && history.highest() <= 30 * 4 + 1);
+  rtc.trackTemp(nullptr);
+  uint32_t count = history.count();
+  delay(70000);
+  rtc.getTime();
+  CHECK(history.count() == count);
+
+  //Statistics against known values
+  UnixRTCTempHistory known;
+  const int16_t values[] = { 100, 101, 99, -3, 250, 88 };
+  double sum = 0, squares = 0;
+  for (int16_t v : values) {
+    known.add(v);
+    sum += v;
+    squares += (double)v * v;
+  }
+  double variance = (squares - sum * sum / 6) / 5;
+  CHECK(known.mean() == 106 && known.variance() == (uint32_t)(variance + 0.5));
+  CHECK(known.lowest() == -3 && known.highest() == 250);
+  CHECK(known.get(0) == 88 && known.get(5) == 100 && known.get(6) == 0);  //Newest first
+  return SIM_TEST_RESULT();
+}
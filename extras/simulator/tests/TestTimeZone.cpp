@@ -0,0 +1,73 @@
+/*
+  UnixRTCTimeZone against glibc's TZ handling: offsets, DST flag, abbreviations, transitions
+  and fromLocal() round trips for a set of POSIX rules.
+*/
+
+#include "UnixRTCTimeZone.h"
+#include "SimTest.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static uint64_t state = 88172645463325252ULL;
+static uint64_t xorshift() {
+  state ^= state << 13;
+  state ^= state >> 7;
+  state ^= state << 17;
+  return state;
+}
+
+int main() {
+  const char* zones[] = {
+    "CET-1CEST,M3.5.0,M10.5.0/3",
+    "EST5EDT,M3.2.0,M11.1.0",
+    "AEST-10AEDT,M10.1.0,M4.1.0/3",
+    "NZST-12NZDT,M9.5.0,M4.1.0/3",
+    "<+0530>-5:30",
+    "IST-1GMT0,M10.5.0,M3.5.0/1",          //Negative DST
+    "XST8XDT",                             //Default US rules
+    "<-03>3<-02>,M3.5.0/-2,M10.5.0/-1",    //Negative transition times
+    "EST5EDT4,J60/1,300/3:30",             //Julian days
+    "UTC0",
+    "<+1245>-12:45<+1345>,M9.5.0/2:45,M4.1.0/3:45"
+  };
+  for (const char* zone : zones) {
+    UnixRTCTimeZone tz;
+    CHECK(tz.begin(zone));
+    setenv("TZ", strcmp(zone, "XST8XDT") ? zone : "XST8XDT,M3.2.0,M11.1.0", 1);  //glibc has no default rules without a tz database
+    tzset();
+    uint32_t bad = 0;
+    for (int i = 0; i < 200000; i++) {
+      uint64_t u = i < 100000 ? 946684800ULL + (uint64_t)i * 63107ULL : 946684800ULL + xorshift() % (7258118400ULL - 946684800ULL - 86400);
+      time_t t = u;
+      struct tm tm;
+      localtime_r(&t, &tm);
+      if (tz.getOffset(u) != tm.tm_gmtoff || tz.toLocal(u) != u + tm.tm_gmtoff || tz.isDST(u) != (tm.tm_isdst > 0) || strcmp(tz.getName(u), tm.tm_zone)) {
+        if (bad++ < 3) printf("%s: %llu gives %d/%d/%s, glibc %ld/%d/%s\n", zone, (unsigned long long)u, tz.getOffset(u), tz.isDST(u), tz.getName(u), tm.tm_gmtoff, tm.tm_isdst, tm.tm_zone);
+      }
+      uint64_t next = tz.nextTransition(u);  //The offset or DST flag changes right there
+      if (next) {
+        time_t before = next - 1, after = next;
+        struct tm a, b;
+        localtime_r(&before, &a);
+        localtime_r(&after, &b);
+        if (a.tm_gmtoff == b.tm_gmtoff && a.tm_isdst == b.tm_isdst && bad++ < 3) printf("%s: no transition at %llu\n", zone, (unsigned long long)next);
+      }
+      uint64_t local = tz.toLocal(u);
+      uint64_t back = tz.fromLocal(local);  //Either u, or the other reading of an ambiguous local time
+      if (back != u) {
+        time_t b = back;
+        localtime_r(&b, &tm);
+        if ((uint64_t)(back + tm.tm_gmtoff) != local && bad++ < 3) printf("%s: fromLocal %llu gives %llu\n", zone, (unsigned long long)u, (unsigned long long)back);
+      }
+    }
+    CHECK(bad == 0);
+  }
+
+  UnixRTCTimeZone tz;
+  CHECK(!tz.begin("CE"));
+  CHECK(tz.getOffset(1700000000ULL) == 0);
+  CHECK(!tz.begin("CET-1CEST,M13.5.0,M10.5.0"));
+  CHECK(!tz.begin("CET-1CEST,M3.5.0"));
+  return SIM_TEST_RESULT();
+}
@@ -0,0 +1,181 @@
+/*
+  Transports and chip variants: several RTCs on two buses, the mock bus, the DS1307 wrapper
+  (century kept in its RAM, Y2100 correction, SRAM) and the DS3232's SRAM and BB32kHz bit.
+*/
+
+#include "AT24C32Sim.h"
+#include "UnixRTCChips.h"
+#include "UnixRTCLog.h"
+#include "SimTest.h"
+#include <string.h>
+
+struct RegisterFile : SimI2CDevice {  //Plain register file with an auto-incrementing pointer, wrapping at size
+  uint8_t regs[256];
+  uint8_t pointer;
+  int size;
+  int writes;
+  RegisterFile(int size) : pointer(0), size(size), writes(0) {
+    memset(regs, 0, sizeof regs);
+  }
+  bool i2cWrite(const uint8_t* data, uint8_t n) {
+    if (!n) return true;
+    pointer = data[0];
+    for (int i = 1; i < n; i++) {
+      regs[pointer] = data[i];
+      pointer = (pointer + 1) % size;
+    }
+    if (n > 1) writes++;
+    return true;
+  }
+  uint8_t i2cRead(uint8_t* data, uint8_t n) {
+    for (int i = 0; i < n; i++) {
+      data[i] = regs[pointer];
+      pointer = (pointer + 1) % size;
+    }
+    return n;
+  }
+};
+
+static void busesAndMocks() {
+  DS3231Sim a;  //Wire, 0x68
+  DS3231Sim b(Wire1, 0x68);
+  DS3231Sim c(Wire1, 0x69);
+  UnixRTC ra;
+  UnixRTC rb(Wire1);
+  UnixRTC rc(Wire1, 0x69);
+  ra.begin();
+  rb.begin();
+  rc.begin();
+  CHECK(ra.setTime(1700000000) && rb.setTime(1800000000) && rc.setTime(1900000000));
+  CHECK(ra.getTime() / 10 == 170000000 && rb.getTime() / 10 == 180000000 && rc.getTime() / 10 == 190000000);
+  UnixRTC missing(Wire1, 0x6A);
+  CHECK(missing.getTime() == 0 && missing.lastError() == RTC_ERR_NACK_ADDRESS);
+
+  UnixRTCMockBus mock;
+  UnixRTC rm(mock);
+  rm.begin();
+  CHECK(rm.setTime(1700000000));
+  CHECK(rm.getTime() == 1700000000);  //The mock's time doesn't move
+  CHECK(mock.regs[0] == 0x20 && mock.regs[1] == 0x13);
+  mock.fail(1);
+  CHECK(rm.getTime() == 1700000000);
+  rm.setRetries(0);
+  mock.fail(1, RTC_ERR_TIMEOUT);
+  CHECK(rm.getTime() == 0 && rm.lastError() == RTC_ERR_TIMEOUT);
+  UnixRTCMockBus mock2(0x51);
+  UnixRTC3232 ds3232(mock2, 0x51);
+  CHECK(ds3232.setTime(1700000000) && ds3232.getTime() == 1700000000);
+  const uint8_t bytes[3] = { 1, 2, 3 };
+  CHECK(ds3232.writeSRAM(0, bytes, 3) && mock2.regs[0x14] == 1);
+  UnixRTC1307 ds1307(mock);
+  CHECK(ds1307.setTime(1700000000) && ds1307.getTime() == 1700000000);
+  UnixRTC3231 byDefault;
+  CHECK(byDefault.getTime() / 10 == 170000000);
+
+  //The EEPROM log shares the RTC's bus
+  AT24C32Sim eeprom(Wire1);
+  UnixRTCLog log(rb);
+  CHECK(log.begin());
+  for (int i = 0; i < 40; i++) CHECK(log.log(1800000000 + i, i));
+  CHECK(log.flush());
+  UnixRTCLog after(rb);
+  CHECK(after.begin());
+  UnixRTCLogRecord r;
+  int n = 0;
+  while (after.readNext(r)) CHECK(r.event == n++);
+  CHECK(n == 40);
+}
+
+static void ds1307() {
+  RegisterFile f(64);
+  Wire.attach(0x68, &f);
+  UnixRTC1307 rtc;
+  rtc.begin();
+  f.regs[0] = 0x80;  //Clock halted
+  CHECK(!rtc.timeValid());
+  CHECK(rtc.setTime(1700000000ULL));
+  CHECK(rtc.timeValid() && rtc.getTime() == 1700000000ULL);
+  CHECK(f.regs[8] == 23);  //Years since 2000, in the first RAM byte
+  const uint64_t march2100 = 4102444800ULL + 86400 * 70;
+  CHECK(rtc.setTime(march2100));
+  CHECK(f.regs[8] == 100 && (f.regs[5] & 0x1F) == 0x03);
+  f.regs[5] &= 0x1F;
+  CHECK(rtc.getTime() == march2100);
+
+  //Century carried over when the year counter wraps
+  rtc.setTime(4102444799ULL);
+  CHECK(f.regs[8] == 99 && rtc.getTime() == 4102444799ULL);
+  f.regs[0] = 0;  //2100-01-01 00:00:00
+  f.regs[1] = 0;
+  f.regs[2] = 0;
+  f.regs[4] = 1;
+  f.regs[5] = 1;
+  f.regs[6] = 0;
+  CHECK(rtc.getTime() == 4102444800ULL && f.regs[8] == 100);
+
+  //Y2100 bug: the chip says Feb 29th 2100
+  f.regs[0] = 0x05;
+  f.regs[1] = 0;
+  f.regs[2] = 0x10;
+  f.regs[4] = 0x29;
+  f.regs[5] = 0x02;
+  f.regs[6] = 0x00;
+  const uint64_t march1st = 4102444800ULL + 59 * 86400ULL + 10 * 3600 + 5;
+  CHECK(rtc.getTime() == march1st);
+  CHECK(f.regs[4] == 0x01 && (f.regs[5] & 0x1F) == 0x03 && (f.regs[2] & 0x40));
+  f.regs[5] &= 0x1F;
+  CHECK(rtc.getTime() == march1st);
+
+  CHECK(rtc.setSQWFreq(RTC_32KHz) && rtc.getSQWFreq() == 32768);
+  CHECK(!rtc.setSQWFreq(RTC_1KHz));
+  rtc.enableSQW();
+  CHECK(rtc.SQWEnabled() && f.regs[7] == 0x13);
+  rtc.disableSQW();
+  rtc.setOutputLevel(true);
+  CHECK(f.regs[7] == 0x83);
+  rtc.disableOscillator();
+  CHECK(!rtc.oscillatorEnabled());
+  rtc.enableOscillator();
+  CHECK(rtc.oscillatorEnabled());
+  Wire.setFault(100);  //Failed reads aren't decoded
+  CHECK(!rtc.oscillatorEnabled() && rtc.getSQWFreq() == 0 && !rtc.SQWEnabled());
+  Wire.setFault(0);
+  CHECK(rtc.oscillatorEnabled() && rtc.getSQWFreq() == 32768);
+
+  uint8_t data[55], back[55];
+  for (int i = 0; i < 55; i++) data[i] = i * 3 + 1;
+  f.writes = 0;
+  CHECK(rtc.writeSRAM(0, data, 55));
+  CHECK(f.writes == 2 && f.regs[8] == 100 && f.regs[9] == 1);  //Century byte kept, split in two writes
+  CHECK(rtc.readSRAM(0, back, 55) && !memcmp(data, back, 55));
+  CHECK(!rtc.writeSRAM(1, data, 55));
+  Wire.detach(0x68);
+}
+
+static void ds3232() {
+  RegisterFile f(256);
+  Wire.attach(0x68, &f);
+  UnixRTC3232 rtc;
+  rtc.begin();
+  uint8_t data[236], back[236];
+  for (int i = 0; i < 236; i++) data[i] = i ^ 0x5A;
+  CHECK(rtc.writeSRAM(0, data, 236) && rtc.readSRAM(0, back, 236) && !memcmp(data, back, 236));
+  CHECK(f.regs[0x14] == 0x5A);
+  CHECK(!rtc.readSRAM(200, back, 40));
+  f.regs[0x0F] = 0x78 | 0x80;
+  rtc.enable32KHzOut(false);
+  CHECK((f.regs[0x0F] & 0x70) == 0x70);  //BB32kHz and CRATE kept
+  f.regs[0x0F] = 0x70;
+  rtc.beginConfig().enable32KHz(true).sqw(1).oscillator(true).batteryBackedSQW(false).alarm1Interrupt(false).alarm2Interrupt(false).commit();
+  CHECK((f.regs[0x0F] & 0x78) == 0x78);
+  rtc.setTime(1700000000ULL);
+  CHECK(rtc.getTime() == 1700000000ULL && (f.regs[0x0F] & 0x70) == 0x70);
+  Wire.detach(0x68);
+}
+
+int main() {
+  ds1307();
+  ds3232();
+  busesAndMocks();
+  return SIM_TEST_RESULT();
+}
@@ -0,0 +1,40 @@
+/*
+  The DS3231 counts 2100 as a leap year: reads across Feb 28th 2100 must skip the chip's Feb 29th,
+  keep the weekday, and stay right for the rest of the century.
+*/
+
+#include "SimTest.h"
+
+int main() {
+  SimFixture sim;
+  UnixRTC& rtc = sim.rtc;
+  CHECK(!rtc.timeValid());  //OSF set at power up
+  CHECK(rtc.setTime(1777777777));
+  CHECK(rtc.timeValid());
+  delay(3000);
+  CHECK(rtc.getTime() == 1777777780);
+
+  CHECK(rtc.setTime(4102444799ULL));  //Dec 31st 2099 23:59:59
+  delay(3000);
+  CHECK(rtc.getTime() == 4102444802ULL);
+  CHECK(sim.regs[5] & 0x80);  //Century bit
+
+  CHECK(rtc.setTime(4107542400ULL - 5));  //Feb 28th 2100 23:59:55
+  delay(10000);
+  CHECK(rtc.getTime() == 4107542405ULL);  //Mar 1st 00:00:05
+  CHECK(sim.regs[4] == 0x01 && sim.regs[5] == 0x83 && (sim.regs[2] & 0x40));  //Corrected in the chip, marked as handled
+  CHECK(sim.regs[3] == 2);  //Monday
+  delay(86400000UL);
+  CHECK(rtc.getTime() == 4107628805ULL);  //Corrected once only
+
+  CHECK(rtc.setTime(4107542399ULL));  //Written straight before the chip's Feb 29th
+  delay(3000);
+  CHECK(rtc.getTime() == 4107542402ULL);
+
+  //Alarms past the bug
+  CHECK(rtc.setTime(4133894400ULL - 10));  //Dec 31st 2100 23:59:50
+  CHECK(rtc.setAlarm1Time(4133894400ULL + 86400 * 20));
+  CHECK(rtc.getAlarm1Time() == 4133894400ULL + 86400 * 20);
+
+  return SIM_TEST_RESULT();
+}
@@ -1,46 +1,308 @@
 #include "UnixRTC.h"
+#include "UnixRTCTempHistory.h"
 
 #include "Arduino.h"  //Arduino core libraries
 
-#include "Wire.h"  //Arduino builtin I2C library
+#ifndef UNIXRTC_NO_WIRE
+UnixRTC::UnixRTC()
+  : UnixRTC(Wire) {}
 
-UnixRTC::UnixRTC() {}  //Library constructor
+UnixRTC::UnixRTC(TwoWire& wire, uint8_t address)
+  : UnixRTC(&this->wire, &UnixRTCBinding<UnixRTCWire>::transfer, &UnixRTCBinding<UnixRTCWire>::control, address) {
+  this->wire = UnixRTCWire(wire);
+}
+#endif
+
+UnixRTC::UnixRTC(void* bus, UnixRTCTransferFunction transfer, const UnixRTCBusControl* control, uint8_t address)
+  : bus(bus), busTransfer(transfer), busControl(control), deviceAddress(address), shadowEnabled(false), shadowValid(false), shadowControl(0), shadowStatus(0), keepStatus(0), incremental(false), minuteValid(false), minuteBase(0), minuteMillis(0), tempState(RTC_TEMP_IDLE), tempTimeout(0), tempStartMillis(0), tempCached(false), lastTemp(0), lastTempMillis(0), tempHistory(nullptr), historyMillis(0), softMode(RTC_SOFT_OFF), softBase(0), softEdges(0), softEdgeMicros(0), softMillis(0), alarmPin(0xFF), alarmMask(0), alarmCallback(nullptr), error(RTC_OK), retries(2), budget(0), sdaPin(0xFF), sclPin(0xFF) {}  //Library constructor
+
+volatile bool UnixRTC::alarmPending = false;
+
+#ifdef UNIXRTC_INSTRUMENT
+static UnixRTCCallStats callStats[UNIXRTC_STATS_SLOTS + 1];  //The last slot is "other"
+static UnixRTCCallStats* activeStats = nullptr;              //Slot of the outermost call in progress
+#define COUNT_STATS(field, n) ((activeStats ? activeStats : &callStats[UNIXRTC_STATS_SLOTS])->field += (n))
+#else
+#define COUNT_STATS(field, n)
+#endif
 
 void UnixRTC::begin() {
-  Wire.begin();  //Begin I2C interface
+  busControl->begin(bus);  //Begin I2C interface
+}
+
+uint64_t UnixRTC::getTime() {  //Returns unix time from RTC
+  UNIXRTC_CALL("getTime");
+  UnixRTCDateTime dt;
+  if (!getDateTime(dt)) return 0;
+  if (minuteValid) return minuteBase + dt.second;  //Set by getDateTime() when incremental reads are enabled
+  return unixFromDate(dt.second, dt.minute, dt.hour, dt.day, dt.month, dt.year);
+}
+
+bool UnixRTC::getDateTime(UnixRTCDateTime& dt) {
+  UNIXRTC_CALL("getDateTime");
+  bool withTemp = historyDue();
+  if (minuteValid && !withTemp && millis() - minuteMillis < UNIXRTC_INCREMENTAL_MS) {  //Less than a minute since the last read, so the minute changed at most once
+    uint8_t second;
+    if (!readRegisters(0x00, &second, 1)) return false;
+    second = bcdToDec(second & 0x7F);
+    if (second >= minuteFields.second) {  //Seconds only go back when the minute changed, which takes a full read (and its Y2100 correction)
+      minuteFields.second = second;
+      minuteMillis = millis();
+      dt = minuteFields;
+      return true;
+    }
+  }
+  uint8_t regs[19];
+  if (!readRegisters(0x00, regs, withTemp ? 19 : 7)) return false;  //Time registers (0x00-0x06), on to the temperature (0x11-0x12) when the history wants a sample
+  if (withTemp) cacheTemp(decodeTemp(regs + 0x11));
+  decodeDateTime(regs, dt);
+  if (incremental) {
+    minuteFields = dt;
+    minuteBase = unixFromDate(0, dt.minute, dt.hour, dt.day, dt.month, dt.year);
+    minuteMillis = millis();
+    minuteValid = true;
+  }
+  return true;
 }
 
-uint64_t UnixRTC::getTime() {   //Returns unix time from RTC
-  Wire.beginTransmission(0x68);  //RTC address
-  Wire.write(0);                 //Memory address 0
-  Wire.endTransmission();        //Ending with 1 written byte, read mode
-  Wire.requestFrom(0x68, 7);     //Request 7 bytes (0x00-0x06)
-  uint8_t second = bcdToDec(Wire.read() & 0x7F);
-  uint8_t minute = bcdToDec(Wire.read() & 0x7F);
-  uint8_t rawHour = Wire.read() & 0x7F;
+bool UnixRTC::readSnapshot(UnixRTCSnapshot& snapshot) {
+  UNIXRTC_CALL("readSnapshot");
+  if (!readRegisters(0x00, snapshot.regs, 19)) {  //Every register (0x00-0x12) in one burst
+    snapshot.error = error;
+    return false;
+  }
+  decodeSnapshot(snapshot, 0x00, 0x12);
+  return true;
+}
+
+void UnixRTC::decodeSnapshot(UnixRTCSnapshot& snapshot, uint8_t first, uint8_t last) {  //Decodes the parts of a snapshot covered by registers first-last
+  const uint8_t* regs = snapshot.regs;
+  snapshot.error = RTC_OK;
+  if (first == 0x00 && last >= 0x06) {
+    uint8_t day;
+    uint8_t month;
+    uint8_t year;
+    snapshot.time = decodeTime(regs, day, month, year);
+    if (last >= 0x0A) snapshot.alarm1 = decodeAlarm(regs + 0x07, true, snapshot.time);
+    if (last >= 0x0D) snapshot.alarm2 = decodeAlarm(regs + 0x0B, false, snapshot.time);
+  }
+  if (first <= 0x07 && last >= 0x0A) snapshot.alarm1Mode = decodeAlarmMode(regs + 0x07, true);
+  if (first <= 0x0B && last >= 0x0D) snapshot.alarm2Mode = decodeAlarmMode(regs + 0x0B, false);
+  if (first <= 0x0E && last >= 0x0E) {
+    uint8_t control = regs[0x0E];
+    snapshot.oscillatorEnabled = !(control & 0x80);
+    snapshot.batteryBackedSQWEnabled = control & 0x40;
+    snapshot.converting = control & 0x20;
+    snapshot.sqwFreq = decodeSQWFreq(control);
+    snapshot.SQWEnabled = !(control & 0x04);
+    snapshot.alm2InterruptEnabled = control & 0x02;
+    snapshot.alm1InterruptEnabled = control & 0x01;
+  }
+  if (first <= 0x0F && last >= 0x0F) {
+    uint8_t status = regs[0x0F];
+    snapshot.timeValid = !(status & 0x80);
+    snapshot.output32KHzEnabled = status & 0x08;
+    snapshot.busy = status & 0x04;
+    snapshot.alm2Tripped = status & 0x02;
+    snapshot.alm1Tripped = status & 0x01;
+  }
+  if (first <= 0x10 && last >= 0x10) snapshot.agingOffset = regs[0x10];
+  if (first <= 0x11 && last >= 0x12) {
+    snapshot.temp = decodeTemp(regs + 0x11);
+    cacheTemp(snapshot.temp);
+  }
+  if (shadowEnabled && first <= 0x0E && last >= 0x0F) {  //A snapshot doubles as a resync
+    shadowControl = regs[0x0E] & 0xDF;
+    shadowStatus = regs[0x0F];
+    shadowValid = true;
+  }
+}
+
+uint64_t UnixRTC::getTime(const UnixRTCSnapshot& snapshot) {
+  return snapshot.time;
+}
+float UnixRTC::getTemp(const UnixRTCSnapshot& snapshot) {
+  return snapshot.temp / 4.0;
+}
+int16_t UnixRTC::getTempInt(const UnixRTCSnapshot& snapshot) {
+  return snapshot.temp;
+}
+int8_t UnixRTC::getAgingOffset(const UnixRTCSnapshot& snapshot) {
+  return snapshot.agingOffset;
+}
+bool UnixRTC::timeValid(const UnixRTCSnapshot& snapshot) {
+  return snapshot.timeValid;
+}
+bool UnixRTC::oscillatorEnabled(const UnixRTCSnapshot& snapshot) {
+  return snapshot.oscillatorEnabled;
+}
+bool UnixRTC::output32KHzEnabled(const UnixRTCSnapshot& snapshot) {
+  return snapshot.output32KHzEnabled;
+}
+uint64_t UnixRTC::getAlarm1Time(const UnixRTCSnapshot& snapshot) {
+  return snapshot.alarm1;
+}
+uint8_t UnixRTC::getAlarm1Mode(const UnixRTCSnapshot& snapshot) {
+  return snapshot.alarm1Mode;
+}
+bool UnixRTC::alm1Tripped(const UnixRTCSnapshot& snapshot) {
+  return snapshot.alm1Tripped;
+}
+bool UnixRTC::alm1InterrptEnabled(const UnixRTCSnapshot& snapshot) {
+  return snapshot.alm1InterruptEnabled;
+}
+uint64_t UnixRTC::getAlarm2Time(const UnixRTCSnapshot& snapshot) {
+  return snapshot.alarm2;
+}
+uint8_t UnixRTC::getAlarm2Mode(const UnixRTCSnapshot& snapshot) {
+  return snapshot.alarm2Mode;
+}
+bool UnixRTC::alm2Tripped(const UnixRTCSnapshot& snapshot) {
+  return snapshot.alm2Tripped;
+}
+bool UnixRTC::alm2InterrptEnabled(const UnixRTCSnapshot& snapshot) {
+  return snapshot.alm2InterruptEnabled;
+}
+uint16_t UnixRTC::getSQWFreq(const UnixRTCSnapshot& snapshot) {
+  return snapshot.sqwFreq;
+}
+bool UnixRTC::batteryBackedSQWEnabled(const UnixRTCSnapshot& snapshot) {
+  return snapshot.batteryBackedSQWEnabled;
+}
+bool UnixRTC::SQWEnabled(const UnixRTCSnapshot& snapshot) {
+  return snapshot.SQWEnabled;
+}
+
+uint64_t UnixRTC::decodeTime(const uint8_t* regs, uint8_t& day, uint8_t& month, uint8_t& year) {  //Decodes registers 0x00-0x06, with Y2100 correction
+  UnixRTCDateTime dt;
+  decodeDateTime(regs, dt);
+  day = dt.day;
+  month = dt.month;
+  year = dt.year;
+  return unixFromDate(dt.second, dt.minute, dt.hour, dt.day, dt.month, dt.year);
+}
+
+void UnixRTC::decodeDateTime(const uint8_t* regs, UnixRTCDateTime& dt) {  //Decodes registers 0x00-0x06, with Y2100 correction
+  dt.second = bcdToDec(regs[0] & 0x7F);
+  dt.minute = bcdToDec(regs[1] & 0x7F);
+  uint8_t rawHour = regs[2] & 0x7F;
   bool Y2100handled = rawHour & 0x40;  //Has the Y2100 bug already been handled? (Uses the AM/PM flag as memory due to RTC limitations)
-  uint8_t hour = bcdToDec(rawHour & 0x3F);
+  dt.hour = bcdToDec(rawHour & 0x3F);
   if (Y2100handled) {  //12H time, convert to 24h (Side effect of using the AM/PM flag as memory)
     bool isPM = rawHour & 0x20;
-    hour = bcdToDec(rawHour & 0x1F);
-    if (hour > 11) hour = 0;
-    if (isPM) hour += 12;
-  }
-  uint8_t dow = (Wire.read() & 0x07) - 1;      //0-6, 0 being Sunday
-  uint8_t day = bcdToDec(Wire.read() & 0x3F);  //Day of month
-  uint8_t temp = Wire.read();
-  uint8_t month = bcdToDec(temp & 0x1F);  //Month without century bit
-  uint8_t year = bcdToDec(Wire.read()) + (temp & 0x80 ? 100 : 0);
-  if (afterY2100bug(day, month, year)) {
+    dt.hour = bcdToDec(rawHour & 0x1F);
+    if (dt.hour > 11) dt.hour = 0;
+    if (isPM) dt.hour += 12;
+  }
+  dt.dayOfWeek = (regs[3] & 0x07) - 1;  //0-6, 0 being Sunday
+  dt.day = bcdToDec(regs[4] & 0x3F);    //Day of month
+  dt.month = bcdToDec(regs[5] & 0x1F);  //Month without century bit
+  dt.year = bcdToDec(regs[6]) + (regs[5] & 0x80 ? 100 : 0);
+  if (afterY2100bug(dt.day, dt.month, dt.year)) {
     if (!Y2100handled) {
-      offsetDate(dow, day, month, year);
-      writeRawTime(second, minute, hour, dow, day, month, year);  //Updates RTC
+      offsetDate(dt.day, dt.month, dt.year);
+      writeRawTime(dt.second, dt.minute, dt.hour, dt.dayOfWeek, dt.day, dt.month, dt.year);  //Updates RTC
     }
   }
-  return unixFromDate(second, minute, hour, day, month, year);
+}
+
+uint64_t UnixRTC::decodeAlarm(const uint8_t* alarm, bool hasSeconds, uint64_t now) {  //First time at or after now that the alarm trips (0 if never)
+  uint8_t mode = decodeAlarmMode(alarm, hasSeconds);
+  if (mode == RTC_ALARM_PER_SECOND) return now;
+  uint8_t almSecond = 0;
+  if (hasSeconds) {
+    almSecond = bcdToDec(*alarm++ & 0x7F);
+  }
+  uint8_t almMinute = bcdToDec(alarm[0] & 0x7F);
+  uint8_t almHour = bcdToDec(alarm[1] & 0x3F);
+  uint8_t almDay = alarm[2] & 0x40 ? (alarm[2] & 0x07) : bcdToDec(alarm[2] & 0x3F);  //Day of week (1-7, 1 being Sunday) or date
+  uint8_t second;
+  uint8_t minute;
+  uint8_t hour;
+  uint8_t dow;
+  uint8_t day;
+  uint8_t month;
+  uint8_t year;
+  dateFromUnix(now, second, minute, hour, dow, day, month, year);
+  uint32_t almTime = almHour * 3600UL + almMinute * 60 + almSecond;  //Second of the day
+  uint64_t midnight = now - (hour * 3600UL + minute * 60 + second);
+  uint64_t alm;
+  uint32_t period;
+  switch (mode) {
+    case RTC_ALARM_PER_MINUTE:
+      alm = now - second + almSecond;
+      period = 60;
+      break;
+    case RTC_ALARM_PER_HOUR:
+      alm = now - (minute * 60 + second) + almMinute * 60 + almSecond;
+      period = 3600;
+      break;
+    case RTC_ALARM_PER_DAY:
+      alm = midnight + almTime;
+      period = 86400;
+      break;
+    case RTC_ALARM_PER_WEEK:
+      alm = midnight + ((almDay + 6 - dow) % 7) * 86400UL + almTime;
+      period = 604800;
+      break;
+    default:  //RTC_ALARM_PER_MONTH, months without that date are skipped by the RTC too (at most 2 in a row)
+      static const uint8_t daysInMonths[12] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+      for (uint8_t i = 0; i < 3; i++) {
+        uint8_t daysInMonth = daysInMonths[month - 1] + (month == 2 && (year & 3) == 0 && year != 100 ? 1 : 0);
+        if (almDay <= daysInMonth) {
+          alm = unixFromDate(almSecond, almMinute, almHour, almDay, month, year);
+          if (alm >= now) return alm;
+        }
+        month++;
+        if (month > 12) {
+          month = 1;
+          year++;
+        }
+      }
+      return 0;
+  }
+  if (alm < now) alm += period;  //Already passed this period
+  return alm;
+}
+
+uint8_t UnixRTC::decodeAlarmMode(const uint8_t* alarm, bool hasSeconds) {  //RTC_ALARM_* from the A1Mx/A2Mx mask bits and DY/DT
+  uint8_t fields = hasSeconds ? 4 : 3;
+  uint8_t masked = 0;
+  while (masked < fields && (alarm[fields - 1 - masked] & 0x80)) masked++;  //Masks are set from the day field down
+  if (masked) return 4 - masked;
+  return alarm[fields - 1] & 0x40 ? RTC_ALARM_PER_WEEK : RTC_ALARM_PER_MONTH;
+}
+
+void UnixRTC::encodeAlarmMode(uint8_t* alarm, uint8_t fields, uint8_t mode, uint8_t dayOfWeek) {  //Sets the mask bits (and DY) of an alarm written as plain date-match values
+  if (mode == RTC_ALARM_PER_WEEK) alarm[fields - 1] = 0x40 | (dayOfWeek + 1);
+  if (mode <= RTC_ALARM_PER_DAY) {
+    for (uint8_t i = fields + mode - 4; i < fields; i++) alarm[i] |= 0x80;
+  }
+}
+
+int16_t UnixRTC::decodeTemp(const uint8_t* regs) {  //Decodes registers 0x11-0x12 to x4 deg C
+  int8_t tempMSB = regs[0];
+  uint8_t tempLSB = regs[1] >> 6;
+  int16_t temp = (tempMSB * 4) | tempLSB;
+  return temp;
+}
+
+uint16_t UnixRTC::decodeSQWFreq(uint8_t control) {
+  uint8_t rawFreq = (control >> 3) & 0x3;
+  switch (rawFreq) {
+    case 0:
+      return 1;
+    case 1:
+      return 1024;
+    case 2:
+      return 4096;
+    default:
+      return 8192;
+  }
 }
 
 bool UnixRTC::setTime(uint64_t unix) {
+  UNIXRTC_CALL("setTime");
   if (unix < 946684800) {  //Time cannot be less than Y2000 (RTC limitation & time can't go backwards)
     return false;
   }
@@ -55,10 +317,65 @@ bool UnixRTC::setTime(uint64_t unix) {
   uint8_t month;
   uint8_t year;
   dateFromUnix(unix, second, minute, hour, dayOfWeek, day, month, year);  //Splits unix time into smaller date parts
-  writeRawTime(second, minute, hour, dayOfWeek, day, month, year);        //Writes time to RTC
+  if (!writeRawTime(second, minute, hour, dayOfWeek, day, month, year)) return false;  //Writes time to RTC
+  timeWritten(unix);
+  return true;
+}
+
+bool UnixRTC::setTimeMs(uint64_t unixMs) {
+  return setTimeAt(unixMs, micros());
+}
+
+bool UnixRTC::setTimeAt(uint64_t unixMs, uint32_t referenceMicros) {  //Writes every register ahead of a whole second, then the seconds register alone on it
+  UNIXRTC_CALL("setTimeAt");
+  for (uint8_t attempt = 0; attempt <= retries; attempt++) {
+    uint32_t now = micros();
+    uint64_t nowUs = unixMs * 1000 + (int32_t)(now - referenceMicros);  //Reference time now
+    uint64_t unix = (nowUs + UNIXRTC_SET_MARGIN_US) / 1000000 + 1;      //First whole second far enough away to prepare for
+    if (unix < 946684800 || unix >= 7258118400) return false;         //Y2000-Y2199
+    uint32_t boundary = now + (uint32_t)(unix * 1000000 - nowUs);      //micros() at that second
+    uint8_t second;
+    uint8_t minute;
+    uint8_t hour;
+    uint8_t dayOfWeek;
+    uint8_t day;
+    uint8_t month;
+    uint8_t year;
+    dateFromUnix(unix, second, minute, hour, dayOfWeek, day, month, year);
+    uint8_t regs[7];
+    encodeRawTime(regs, second, minute, hour, dayOfWeek, day, month, year);
+    if (!writeRegisters(0x00, regs, 7)) return false;  //Restarts the countdown, the next tick is a second away
+    while ((int32_t)(boundary - micros()) > 500000) {}  //Each seconds write restarts the countdown, so the last one before the boundary must be under a second ahead of it
+    uint32_t latency = 0xFFFFFFFF;
+    for (uint8_t i = 0; i < 2; i++) {  //Times the final write by making it early (harmless, the registers still hold it), shortest of two
+      uint32_t start = micros();
+      if (writeOnce(0x00, regs, 1) != RTC_OK) break;
+      uint32_t took = micros() - start;
+      if (took < latency) latency = took;
+    }
+    if (latency == 0xFFFFFFFF || (int32_t)(boundary - latency - micros()) < 0) continue;  //Failed or too slow, try the next second
+    while ((int32_t)(boundary - latency - micros()) > 0) {}  //The seconds register is latched as the write completes
+    if (writeOnce(0x00, regs, 1) == RTC_OK) {
+      timeWritten(unix);
+      return true;
+    }
+  }
+  error = RTC_ERR_TIMEOUT;  //Never on time, the RTC is still within a second
+  return false;
+}
+
+void UnixRTC::timeWritten(uint64_t unix) {  //Flag fix-ups after the seconds were written, kept off the timed path
+  if (softMode == RTC_SOFT_SQW) {  //Writing the seconds restarts the countdown, the next edge is a second away
+    noInterrupts();
+    softBase = unix - softEdges;
+    softEdgeMicros = micros();
+    interrupts();
+  } else if (softMode == RTC_SOFT_POLLED) {
+    softBase = unix;
+    softMillis = millis();
+  }
   assumeTimeValid();
   enableOscillator();
-  return true;
 }
 
 uint8_t UnixRTC::decToBcd(uint8_t i) {  //Converts decimal to RTC BCD format
@@ -74,7 +391,7 @@ bool UnixRTC::afterY2100bug(uint8_t day, uint8_t month, uint8_t year) {  //Retur
   }
   return false;  //Before Feb 29, 2100
 }
-void UnixRTC::offsetDate(uint8_t& dow, uint8_t& day, uint8_t& month, uint8_t& year) {  //Year as 00-199
+void UnixRTC::offsetDate(uint8_t& day, uint8_t& month, uint8_t& year) {  //Year as 00-199
   uint8_t daysInMonths[12] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
   if ((year % 4) == 0) {
     daysInMonths[1] = 29;
@@ -88,270 +405,564 @@ void UnixRTC::offsetDate(uint8_t& dow, uint8_t& day, uint8_t& month, uint8_t& ye
       year++;
     }
   }
-  dow++;
-  if (dow >= 7) dow = 0;
 }
 
-void UnixRTC::writeRawTime(uint8_t sec, uint8_t min, uint8_t hr, uint8_t dow, uint8_t day, uint8_t month, uint8_t year) {  //Used internally for Y2100 correction on read and writing
-  Wire.beginTransmission(0x68);
-  Wire.write(0);              //Memory address 0
-  Wire.write(decToBcd(sec));  //Writes second, removes Clock Halt on DS1307
-  Wire.write(decToBcd(min));
+bool UnixRTC::writeRawTime(uint8_t sec, uint8_t min, uint8_t hr, uint8_t dow, uint8_t day, uint8_t month, uint8_t year) {  //Used internally for Y2100 correction on read and writing
+  uint8_t regs[7];
+  encodeRawTime(regs, sec, min, hr, dow, day, month, year);
+  return writeRegisters(0x00, regs, 7);
+}
+
+void UnixRTC::encodeRawTime(uint8_t* regs, uint8_t sec, uint8_t min, uint8_t hr, uint8_t dow, uint8_t day, uint8_t month, uint8_t year) {
+  regs[0] = decToBcd(sec);  //Writes second, removes Clock Halt on DS1307
+  regs[1] = decToBcd(min);
   bool mode = afterY2100bug(day, month, year);
   if (mode) {  //After Feb 2100, 12h
     bool isPM = hr > 11;
     if (isPM) hr -= 12;
     if (hr == 0) hr = 12;
-    Wire.write(decToBcd(hr) | (isPM ? 0x60 : 0x40));
+    regs[2] = decToBcd(hr) | (isPM ? 0x60 : 0x40);
   } else {  //Before Feb 2100, 24h
-    Wire.write(decToBcd(hr));
+    regs[2] = decToBcd(hr);
   }
-  Wire.write(dow + 1);  //Never exceeds 15 so BCD encoding is unnessecary (0-6)
-  Wire.write(decToBcd(day));
-  Wire.write(decToBcd(month) | (year > 99 ? 0x80 : 0));  //Month with century bit
-  Wire.write(decToBcd(year % 100));
-  Wire.endTransmission();
+  regs[3] = dow + 1;  //Never exceeds 15 so BCD encoding is unnessecary (0-6)
+  regs[4] = decToBcd(day);
+  regs[5] = decToBcd(month) | (year > 99 ? 0x80 : 0);  //Month with century bit
+  regs[6] = decToBcd(year % 100);
+}
+
+//Calendar conversion works on days and seconds since 2000-01-01 in 32 bits, the 64 bit unix time only appears at the boundary.
+//Divisions by constants are replaced with multiply-and-shift reciprocals, each checked over its full input range.
+#define Y2000_UNIX 946684800ULL  //2000-01-01 00:00:00
+#define Y2200_DAYS 73049         //2200-01-01, days since 2000-01-01
+
+static constexpr uint16_t cumulativeDays[13] = { 0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334, 365 };  //Days before each month (non-leap)
+
+static inline uint32_t daysFromDate(uint8_t day, uint8_t month, uint8_t year) {  //Days since 2000-01-01
+  bool leap = !(year & 3) && year != 100;                                   //2100 is not a leap year
+  uint32_t days = year * 365UL + ((year + 3) >> 2) - (year > 100 ? 1 : 0);  //Days before the year
+  return days + cumulativeDays[month - 1] + (leap && month > 2 ? 1 : 0) + day - 1;
+}
+
+static inline uint8_t daysInMonth(uint8_t month, uint8_t year) {
+  return cumulativeDays[month] - cumulativeDays[month - 1] + (month == 2 && !(year & 3) && year != 100 ? 1 : 0);
+}
+
+static inline uint32_t splitUnix(uint64_t unix, uint32_t& sod) {  //Days since 2000-01-01 and second of day
+  uint64_t s = unix - Y2000_UNIX;                                 //Under 2^33 until Y2200
+  uint32_t q = s >> 7;                                            //Seconds / 128, so days = q / 675
+  uint32_t h = q >> 16;
+  uint32_t x = h * 61 + (q & 0xFFFF);  //65536 = 97 * 675 + 61
+  uint32_t days = (x * 97) >> 16;      //x / 675, low by at most one
+  uint32_t rem = x - days * 675;
+  uint32_t carry = rem >= 675 ? 1 : 0;
+  rem -= carry * 675;
+  sod = (rem << 7) | ((uint32_t)s & 0x7F);
+  return days + carry + h * 97;
+}
+
+static inline void timeOfDay(uint32_t sod, uint8_t& second, uint8_t& minute, uint8_t& hour) {
+  uint32_t mod = ((sod >> 2) * 17477) >> 18;  //sod / 60
+  second = sod - mod * 60;
+  uint32_t h = (mod * 1093) >> 16;  //mod / 60
+  hour = h;
+  minute = mod - h * 60;
+}
+
+static inline uint8_t weekday(uint32_t days) {      //0-6, 0 being Sunday
+  uint32_t w = days + 6;                            //2000-01-01 was a Saturday
+  uint32_t w7 = ((w >> 10) << 1) + (w & 1023);      //Same remainder mod 7, as 1024 = 2 (mod 7)
+  return w7 - ((w7 * 1171) >> 13) * 7;              //w7 % 7
+}
+
+static inline void dateOfDays(uint32_t days, uint8_t& day, uint8_t& month, uint8_t& year) {
+  uint32_t late = days >= 36525 ? 1 : 0;  //From 2100, insert a phantom Feb 29 so every fourth year is leap again
+  days -= late * 36525;
+  days += (late && days >= 59) ? 1 : 0;
+  uint32_t quad = (days * 22967) >> 25;  //days / 1461, 4 year cycles starting with a leap year
+  uint32_t r = days - quad * 1461;
+  uint32_t yearOfQuad = r >= 366 ? ((r - 1) * 1437) >> 19 : 0;  //(r - 1) / 365
+  uint32_t doy = r - (yearOfQuad ? 1 + yearOfQuad * 365 : 0);
+  year = late * 100 + quad * 4 + yearOfQuad;
+  uint32_t leapDay = yearOfQuad == 0 ? 1 : 0;
+  uint32_t m = doy >> 5;  //Either the month or the one before it
+  m += doy >= cumulativeDays[m + 1] + (m + 1 >= 2 ? leapDay : 0) ? 1 : 0;
+  day = doy - cumulativeDays[m] - (m >= 2 ? leapDay : 0) + 1;
+  month = m + 1;
 }
 
 uint64_t UnixRTC::unixFromDate(uint8_t second, uint8_t minute, uint8_t hour, uint8_t day, uint8_t month, uint8_t year) {  //Internal conversion for unix time
-  uint8_t my = (month >= 3) ? 1 : 0;
-  uint16_t y = year + 30 + my;
-  uint16_t dm = 0;
-  for (int i = 0; i < month - 1; i++) dm += (i < 7) ? ((i == 1) ? 28 : ((i & 1) ? 30 : 31)) : ((i & 1) ? 31 : 30);
-  return ((((day - 1 + dm + ((y + 1) / 4) - ((y + 69) / 100) + ((y + 369) / 400)) + (365UL * (y - my))) * (uint32_t)24 + hour) * (uint32_t)60 + minute) * (uint64_t)60 + second;
+  uint32_t sod = hour * 3600UL + minute * 60 + second;
+  return Y2000_UNIX + ((uint64_t)(daysFromDate(day, month, year) * 675) << 7) + sod;  //days * 86400 as days * 675 * 128
 }
 
 void UnixRTC::dateFromUnix(uint64_t unix, uint8_t& second, uint8_t& minute, uint8_t& hour, uint8_t& dayOfWeek, uint8_t& day, uint8_t& month, uint8_t& year) {  //Internal conversion for unix time
-  second = unix % 60;
-  uint32_t t = unix / 60;
-  minute = t % 60;
-  t /= 60;
-  hour = t % 24;
-  t /= 24;
-  dayOfWeek = (t + 4) % 7;
-  uint32_t z = t + 719468;
-  uint8_t era = z / 146097ul;
-  uint32_t doe = z - era * 146097ul;
-  uint32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
-  uint32_t y = yoe + era * 400;
-  uint32_t doy = doe - (yoe * 365 + yoe / 4 - yoe / 100);
-  uint32_t mp = (doy * 5 + 2) / 153;
-  day = doy - (mp * 153 + 2) / 5 + 1;
-  month = mp + (mp < 10 ? 3 : -9);
-  y += (month <= 2);
-  year = y - 2000;
+  uint32_t sod;
+  uint32_t days = splitUnix(unix, sod);
+  timeOfDay(sod, second, minute, hour);
+  dayOfWeek = weekday(days);
+  dateOfDays(days, day, month, year);
+}
+
+void UnixRTC::toCalendar(const uint64_t* in, const UnixRTCDateFields& out, size_t n) {
+  uint32_t days[16];  //Converted in blocks, each stage a simple loop over 32 bit values that compilers can vectorize
+  uint32_t sods[16];
+  for (size_t base = 0; base < n; base += 16) {
+    size_t count = n - base < 16 ? n - base : 16;
+    uint8_t* second = out.second + base;  //Local pointers, byte stores could otherwise alias out
+    uint8_t* minute = out.minute + base;
+    uint8_t* hour = out.hour + base;
+    uint8_t* dayOfWeek = out.dayOfWeek + base;
+    uint8_t* day = out.day + base;
+    uint8_t* month = out.month + base;
+    uint8_t* year = out.year + base;
+    for (size_t i = 0; i < count; i++) days[i] = splitUnix(in[base + i], sods[i]);
+    for (size_t i = 0; i < count; i++) timeOfDay(sods[i], second[i], minute[i], hour[i]);
+    for (size_t i = 0; i < count; i++) dayOfWeek[i] = weekday(days[i]);
+    for (size_t i = 0; i < count; i++) dateOfDays(days[i], day[i], month[i], year[i]);
+  }
+}
+
+void UnixRTC::toCalendarSorted(const uint64_t* in, const UnixRTCDateFields& out, size_t n) {
+  uint64_t dayStart = 0;  //Unix time at midnight of the current day
+  uint32_t days = 0;
+  uint8_t dow = 0;
+  uint8_t day = 0;
+  uint8_t month = 0;
+  uint8_t year = 0;
+  for (size_t i = 0; i < n; i++) {
+    uint64_t t = in[i];
+    uint32_t sod;
+    if (dayStart && t >= dayStart && t - dayStart < 86400) {  //Same day, only the time of day changes
+      sod = t - dayStart;
+    } else if (dayStart && t >= dayStart + 86400 && t - dayStart < 2 * 86400UL) {  //Next day, step the date
+      dayStart += 86400;
+      sod = t - dayStart;
+      days++;
+      dow = dow == 6 ? 0 : dow + 1;
+      if (day < 28) {
+        day++;
+      } else {
+        dateOfDays(days, day, month, year);
+      }
+    } else {  //Unsorted or a gap of more than a day
+      days = splitUnix(t, sod);
+      dayStart = t - sod;
+      dow = weekday(days);
+      dateOfDays(days, day, month, year);
+    }
+    timeOfDay(sod, out.second[i], out.minute[i], out.hour[i]);
+    out.dayOfWeek[i] = dow;
+    out.day[i] = day;
+    out.month[i] = month;
+    out.year[i] = year;
+  }
+}
+
+void UnixRTC::fromCalendar(const UnixRTCDateFields& in, uint64_t* out, size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    uint32_t sod = in.hour[i] * 3600UL + in.minute[i] * 60 + in.second[i];
+    out[i] = Y2000_UNIX + ((uint64_t)(daysFromDate(in.day[i], in.month[i], in.year[i]) * 675) << 7) + sod;
+  }
+}
+
+void UnixRTC::toDateTime(uint64_t unix, UnixRTCDateTime& dt) {
+  dateFromUnix(unix, dt.second, dt.minute, dt.hour, dt.dayOfWeek, dt.day, dt.month, dt.year);
+}
+
+uint64_t UnixRTC::fromDateTime(const UnixRTCDateTime& dt) {
+  return unixFromDate(dt.second, dt.minute, dt.hour, dt.day, dt.month, dt.year);
+}
+
+bool UnixRTC::dateTimeValid(const UnixRTCDateTime& dt) {
+  if (dt.second > 59 || dt.minute > 59 || dt.hour > 23 || dt.year > 199) return false;
+  if (dt.month < 1 || dt.month > 12) return false;
+  return dt.day >= 1 && dt.day <= daysInMonth(dt.month, dt.year);
+}
+
+uint16_t UnixRTC::dayOfYear(const UnixRTCDateTime& dt) {
+  bool leap = !(dt.year & 3) && dt.year != 100;
+  return cumulativeDays[dt.month - 1] + (leap && dt.month > 2 ? 1 : 0) + dt.day;
+}
+
+static uint8_t isoWeeks(int16_t year) {  //Weeks in an ISO year (years since 2000)
+  if (year < 0) return 52;               //1999 started on a Friday
+  uint8_t jan1 = weekday(daysFromDate(1, 1, year));
+  bool leap = !(year & 3) && year != 100;
+  return jan1 == 4 || (leap && jan1 == 3) ? 53 : 52;  //Years starting on a Thursday, or leap years starting on a Wednesday
+}
+
+uint8_t UnixRTC::isoWeek(const UnixRTCDateTime& dt, uint16_t* isoYear) {  //Week 1 holds the year's first Thursday
+  uint8_t dow = weekday(daysFromDate(dt.day, dt.month, dt.year));  //Not dt.dayOfWeek, so a hand filled dt works
+  int16_t week = (dayOfYear(dt) - (dow ? dow : 7) + 10) / 7;       //Monday based
+  int16_t year = dt.year;
+  if (week < 1) {  //Last week of the previous year
+    year--;
+    week = isoWeeks(year);
+  } else if (week > isoWeeks(year)) {  //First week of the next year
+    year++;
+    week = 1;
+  }
+  if (isoYear) *isoYear = 2000 + year;
+  return week;
+}
+
+bool UnixRTC::addSeconds(UnixRTCDateTime& dt, int32_t seconds) {  //Days since 2000-01-01 and second of day in 32 bits
+  int32_t days = daysFromDate(dt.day, dt.month, dt.year) + seconds / 86400;
+  int32_t sod = dt.hour * 3600L + dt.minute * 60 + dt.second + seconds % 86400;
+  if (sod < 0) {
+    sod += 86400;
+    days--;
+  } else if (sod >= 86400) {
+    sod -= 86400;
+    days++;
+  }
+  if (days < 0 || days >= Y2200_DAYS) return false;
+  timeOfDay(sod, dt.second, dt.minute, dt.hour);
+  dateOfDays(days, dt.day, dt.month, dt.year);
+  dt.dayOfWeek = weekday(days);
+  return true;
+}
+
+bool UnixRTC::addDays(UnixRTCDateTime& dt, int32_t days) {
+  int32_t total = daysFromDate(dt.day, dt.month, dt.year) + days;
+  if (total < 0 || total >= Y2200_DAYS) return false;
+  dateOfDays(total, dt.day, dt.month, dt.year);
+  dt.dayOfWeek = weekday(total);
+  return true;
+}
+
+bool UnixRTC::setDateTime(const UnixRTCDateTime& dt) {
+  UNIXRTC_CALL("setDateTime");
+  if (!writeDateTime(dt)) return false;
+  timeWritten(softMode == RTC_SOFT_OFF ? 0 : fromDateTime(dt));  //Unix time is only needed to rebase a running software clock
+  return true;
+}
+
+bool UnixRTC::writeDateTime(const UnixRTCDateTime& dt) {
+  if (!dateTimeValid(dt)) return false;
+  uint8_t regs[7];
+  encodeRawTime(regs, dt.second, dt.minute, dt.hour, weekday(daysFromDate(dt.day, dt.month, dt.year)), dt.day, dt.month, dt.year);
+  return writeRegisters(0x00, regs, 7);
+}
+
+static const char digitPairs[201] PROGMEM = "00010203040506070809101112131415161718192021222324252627282930313233343536373839404142434445464748495051525354555657585960616263646566676869707172737475767778798081828384858687888990919293949596979899";  //"00" to "99", two characters per lookup
+
+static inline char* putPair(char* out, uint8_t value) {  //Writes 0-99 as two digits
+  out[0] = pgm_read_byte(&digitPairs[value * 2]);
+  out[1] = pgm_read_byte(&digitPairs[value * 2 + 1]);
+  return out + 2;
+}
+
+static inline bool getDigits(const char*& text, uint8_t count, uint16_t& value) {  //Reads exactly count digits
+  value = 0;
+  for (uint8_t i = 0; i < count; i++) {
+    uint8_t digit = text[i] - '0';
+    if (digit > 9) return false;
+    value = value * 10 + digit;
+  }
+  text += count;
+  return true;
+}
+
+uint8_t UnixRTC::formatISO8601(uint64_t unix, char* buffer, uint8_t size, int16_t offset) {
+  return formatTimestamp(unix, -1, buffer, size, offset);
+}
+
+uint8_t UnixRTC::formatISO8601Ms(uint64_t unixMs, char* buffer, uint8_t size, int16_t offset) {
+  uint64_t unix = unixMs / 1000;
+  return formatTimestamp(unix, unixMs - unix * 1000, buffer, size, offset);
+}
+
+uint8_t UnixRTC::formatTimestamp(uint64_t unix, int16_t ms, char* buffer, uint8_t size, int16_t offset) {  //YYYY-MM-DDTHH:MM:SS[.mmm](Z|+HH:MM), returns the length or 0
+  uint8_t length = (ms >= 0 ? 24 : 20) + (offset ? 5 : 0);
+  if (size <= length || offset <= -1440 || offset >= 1440) return 0;
+  unix += offset * 60L;  //Local time
+  if (unix < Y2000_UNIX || unix >= 7258118400) return 0;
+  uint32_t sod;
+  uint32_t days = splitUnix(unix, sod);
+  uint8_t second;
+  uint8_t minute;
+  uint8_t hour;
+  uint8_t day;
+  uint8_t month;
+  uint8_t year;
+  timeOfDay(sod, second, minute, hour);
+  dateOfDays(days, day, month, year);
+  char* out = buffer;
+  out = putPair(out, year < 100 ? 20 : 21);
+  out = putPair(out, year < 100 ? year : year - 100);
+  *out++ = '-';
+  out = putPair(out, month);
+  *out++ = '-';
+  out = putPair(out, day);
+  *out++ = 'T';
+  out = putPair(out, hour);
+  *out++ = ':';
+  out = putPair(out, minute);
+  *out++ = ':';
+  out = putPair(out, second);
+  if (ms >= 0) {
+    *out++ = '.';
+    *out++ = '0' + ms / 100;
+    out = putPair(out, ms % 100);
+  }
+  if (offset) {
+    uint16_t magnitude = offset < 0 ? -offset : offset;
+    *out++ = offset < 0 ? '-' : '+';
+    out = putPair(out, magnitude / 60);
+    *out++ = ':';
+    out = putPair(out, magnitude % 60);
+  } else {
+    *out++ = 'Z';
+  }
+  *out = 0;
+  return length;
+}
+
+bool UnixRTC::parseISO8601(const char* text, uint64_t& unix, uint16_t* ms) {  //YYYY-MM-DD(T| )HH:MM:SS[.fraction][Z|(+|-)HH[:]MM], no zone means UTC
+  uint16_t year;
+  uint16_t month;
+  uint16_t day;
+  uint16_t hour;
+  uint16_t minute;
+  uint16_t second;
+  if (!getDigits(text, 4, year) || *text++ != '-' || !getDigits(text, 2, month) || *text++ != '-' || !getDigits(text, 2, day)) return false;
+  if (*text != 'T' && *text != 't' && *text != ' ') return false;
+  text++;
+  if (!getDigits(text, 2, hour) || *text++ != ':' || !getDigits(text, 2, minute) || *text++ != ':' || !getDigits(text, 2, second)) return false;
+  uint16_t fraction = 0;
+  if (*text == '.' || *text == ',') {
+    text++;
+    uint8_t digits = 0;
+    while ((uint8_t)(*text - '0') <= 9) {
+      if (digits < 3) fraction = fraction * 10 + (*text - '0');
+      digits++;
+      text++;
+    }
+    if (!digits) return false;
+    for (; digits < 3; digits++) fraction *= 10;
+  }
+  int16_t offset = 0;
+  if (*text == 'Z' || *text == 'z') {
+    text++;
+  } else if (*text == '+' || *text == '-') {
+    bool negative = *text++ == '-';
+    uint16_t offsetHour;
+    uint16_t offsetMinute;
+    if (!getDigits(text, 2, offsetHour)) return false;
+    if (*text == ':') text++;
+    if (!getDigits(text, 2, offsetMinute) || offsetHour > 23 || offsetMinute > 59) return false;
+    offset = offsetHour * 60 + offsetMinute;
+    if (negative) offset = -offset;
+  }
+  if (*text) return false;
+  if (year < 2000 || year > 2199 || month < 1 || month > 12 || hour > 23 || minute > 59 || second > 59) return false;
+  year -= 2000;
+  if (day < 1 || day > daysInMonth(month, year)) return false;
+  uint64_t result = unixFromDate(second, minute, hour, day, month, year) - offset * 60L;
+  if (result < Y2000_UNIX || result >= 7258118400) return false;
+  unix = result;
+  if (ms) *ms = fraction;
+  return true;
 }
 
 int8_t UnixRTC::getAgingOffset() {
-  Wire.beginTransmission(0x68);
-  Wire.write(0x10);
-  Wire.endTransmission();
-  Wire.requestFrom(0x68, 1);
-  return Wire.read();
+  UNIXRTC_CALL("getAgingOffset");
+  uint8_t age;
+  if (!readRegisters(0x10, &age, 1)) return 0;
+  return age;
 }
 
 void UnixRTC::setAgingOffset(int8_t age) {
-  Wire.beginTransmission(0x68);
-  Wire.write(0x10);
-  Wire.write(age);
-  Wire.endTransmission();
+  UNIXRTC_CALL("setAgingOffset");
+  writeRegisters(0x10, (const uint8_t*)&age, 1);
 }
 
 int16_t UnixRTC::getTempInt(bool force) {
+  UNIXRTC_CALL("getTempInt");
   if (force) {
-    Wire.beginTransmission(0x68);
-    Wire.write(0xE);
-    Wire.endTransmission();
-    Wire.requestFrom(0x68, 2);
-    uint8_t oldControl = Wire.read();
-    bool isBusy = Wire.read() & 0x4;
-    if (!isBusy) {
-      Wire.beginTransmission(0x68);
-      Wire.write(0xE);
-      Wire.write(oldControl | 0x20);
-      Wire.endTransmission();
-    }
+    startTempConversion();
     for (int a = 0; a < 30; a++) {  //Timeout after 30 busy checks
-      Wire.beginTransmission(0x68);
-      Wire.write(0xE);
-      Wire.endTransmission();
-      Wire.requestFrom(0x68, 1);
-      if (!(Wire.read() & 0x20)) break;
+      if (tempReady() != RTC_TEMP_PENDING) break;
       delay(50);
     }
+    if (tempState == RTC_TEMP_READY) return lastTemp;
+  }
+  uint8_t regs[2];
+  if (readRegisters(0x11, regs, 2)) cacheTemp(decodeTemp(regs));  //Otherwise the last reading
+  return lastTemp;
+}
+
+bool UnixRTC::startTempConversion(uint16_t timeoutMs) {
+  UNIXRTC_CALL("startTempConversion");
+  if (tempState == RTC_TEMP_PENDING) return false;
+  uint8_t regs[2];
+  if (!readRegisters(0x0E, regs, 2)) return false;
+  if (!(regs[1] & 0x4)) {  //BSY clear, start a conversion (otherwise join the automatic one)
+    uint8_t control = (shadowEnabled && shadowValid ? shadowControl : regs[0]) | 0x20;
+    if (!writeRegisters(0x0E, &control, 1)) return false;
+  }
+  tempState = RTC_TEMP_PENDING;
+  tempTimeout = timeoutMs;
+  tempStartMillis = millis();
+  return true;
+}
+
+uint8_t UnixRTC::tempReady() {
+  UNIXRTC_CALL("tempReady");
+  if (tempState != RTC_TEMP_PENDING) return tempState;
+  uint8_t regs[5];
+  bool read = readRegisters(0x0E, regs, 5);  //Control, status, aging and temperature in one read
+  if (read && !(regs[0] & 0x20) && !(regs[1] & 0x04)) {  //CONV and BSY both clear
+    cacheTemp(decodeTemp(regs + 3));
+    tempState = RTC_TEMP_READY;
+  } else if (millis() - tempStartMillis >= tempTimeout) {
+    tempState = RTC_TEMP_TIMEOUT;
+  }
+  return tempState;
+}
+
+int16_t UnixRTC::readTemp(uint32_t* ageMs) {
+  UNIXRTC_CALL("readTemp");
+  if (!tempCached) getTempInt();  //Nothing read yet
+  if (ageMs) *ageMs = millis() - lastTempMillis;
+  return lastTemp;
+}
+
+void UnixRTC::trackTemp(UnixRTCTempHistory* history) {
+  tempHistory = history;
+  historyMillis = millis() - UNIXRTC_TEMP_PERIOD_MS;  //First sample with the next read
+}
+
+bool UnixRTC::historyDue() {
+  return tempHistory && millis() - historyMillis >= UNIXRTC_TEMP_PERIOD_MS;
+}
+
+void UnixRTC::cacheTemp(int16_t temp) {
+  lastTemp = temp;
+  lastTempMillis = millis();
+  tempCached = true;
+  if (historyDue()) {
+    tempHistory->add(temp);
+    historyMillis = lastTempMillis;
   }
-  Wire.beginTransmission(0x68);
-  Wire.write(0x11);
-  Wire.endTransmission();
-  Wire.requestFrom(0x68, 2);
-  int8_t tempMSB = Wire.read();
-  uint8_t tempLSB = Wire.read() >> 6;
-  int16_t temp = (tempMSB * 4) | tempLSB;
-  return temp;
 }
 
 float UnixRTC::getTemp(bool force) {
+  UNIXRTC_CALL("getTemp");
   return getTempInt(force) / 4.0;
 }
 
 bool UnixRTC::timeValid() {
-  Wire.beginTransmission(0x68);
-  Wire.write(0xF);
-  Wire.endTransmission();
-  Wire.requestFrom(0x68, 1);
-  return !(Wire.read() & 0x80);
+  UNIXRTC_CALL("timeValid");
+  uint8_t status;
+  return readStatus(status) && !(status & 0x80);  //OSF is volatile, always read from the RTC
 }
 
 void UnixRTC::assumeTimeValid() {
-  Wire.beginTransmission(0x68);
-  Wire.write(0xF);
-  Wire.endTransmission();
-  Wire.requestFrom(0x68, 1);
-  uint8_t status = Wire.read();
+  UNIXRTC_CALL("assumeTimeValid");
+  if (shadowEnabled) {
+    if (!shadowValid && !resync()) return;
+    writeStatus((shadowStatus & 0x78) | 0x03);  //Always written, OSF sets again on an RTC-only power loss. A1F/A2F are written as 1 which leaves them unchanged
+    return;
+  }
+  uint8_t status;
+  if (!readRegisters(0x0F, &status, 1)) return;  //Never write back bits that weren't read
   if (status & 0x80) {  // Oscillator stopped
-    Wire.beginTransmission(0x68);
-    Wire.write(0xF);
-    Wire.write(status & 0x7F);
-    Wire.endTransmission();
+    writeStatus((status & 0x7F) | 0x03);
   }
 }
 
 bool UnixRTC::oscillatorEnabled() {
-  Wire.beginTransmission(0x68);
-  Wire.write(0xE);
-  Wire.endTransmission();
-  Wire.requestFrom(0x68, 1);
-  return Wire.read() & 0x80;
+  UNIXRTC_CALL("oscillatorEnabled");
+  uint8_t control;
+  return readControl(control) && !(control & 0x80);  //EOSC set stops the oscillator on battery
 }
 
 void UnixRTC::enableOscillator(bool enable) {
-  Wire.beginTransmission(0x68);
-  Wire.write(0xE);
-  Wire.endTransmission();
-  Wire.requestFrom(0x68, 1);
-  uint8_t control = Wire.read();
-  uint8_t newControl = control;
-  if (enable) {
-    newControl |= 0x80;
-  } else {
-    newControl &= 0x7F;
-  }
-  if (newControl != control) {
-    Wire.beginTransmission(0x68);
-    Wire.write(0xE);
-    Wire.write(newControl);
-    Wire.endTransmission();
-  }
+  UNIXRTC_CALL("enableOscillator");
+  updateControl(0x80, enable ? 0 : 0x80);
 }
 void UnixRTC::disableOscillator() {
   enableOscillator(false);
 }
 
 bool UnixRTC::output32KHzEnabled() {
-  Wire.beginTransmission(0x68);
-  Wire.write(0xF);
-  Wire.endTransmission();
-  Wire.requestFrom(0x68, 1);
-  return Wire.read() & 0x8;
+  UNIXRTC_CALL("output32KHzEnabled");
+  if (shadowEnabled) {
+    if (!shadowValid && !resync()) return false;
+    return shadowStatus & 0x8;
+  }
+  uint8_t status;
+  return readStatus(status) && (status & 0x8);
 }
 
 void UnixRTC::enable32KHzOut(bool enable) {
-  Wire.beginTransmission(0x68);
-  Wire.write(0xF);
-  Wire.endTransmission();
-  Wire.requestFrom(0x68, 1);
-  uint8_t status = Wire.read();
+  UNIXRTC_CALL("enable32KHzOut");
+  uint8_t status;
+  if (shadowEnabled) {
+    if (!shadowValid) resync();
+    status = shadowStatus;
+  } else if (!readRegisters(0x0F, &status, 1)) {
+    return;
+  }
   uint8_t newStatus = status;
   if (enable) {
     newStatus |= 0x8;
   } else {
-    newStatus &= 0x87;
+    newStatus &= 0xF7;
   }
   if (newStatus != status) {
-    Wire.beginTransmission(0x68);
-    Wire.write(0xF);
-    Wire.write(newStatus);
-    Wire.endTransmission();
+    writeStatus(newStatus | 0x83);  //Flags written as 1 are left unchanged by the RTC
   }
 }
 void UnixRTC::disable32KHzOut() {
   enable32KHzOut(false);
 }
 
-uint64_t UnixRTC::getAlarm1Time() {  //This function assumes the alarm was set by this library, for simplicity
-  Wire.beginTransmission(0x68);
-  Wire.write(0x00);
-  Wire.endTransmission();
-  Wire.requestFrom(0x68, 7);
-  uint8_t second = bcdToDec(Wire.read());
-  uint8_t minute = bcdToDec(Wire.read());
-  uint8_t rawHour = Wire.read() & 0x7F;
-  bool Y2100handled = rawHour & 0x40;  //Has the Y2100 bug already been handled? (Uses the AM/PM flag as memory due to RTC limitations)
-  uint8_t hour = bcdToDec(rawHour & 0x3F);
-  if (Y2100handled) {  //12H time, convert to 24h (Side effect of using the AM/PM flag as memory)
-    bool isPM = rawHour & 0x20;
-    hour = bcdToDec(rawHour & 0x1F);
-    if (hour > 11) hour = 0;
-    if (isPM) hour += 12;
-  }
-  Wire.read();  //DoW not needed
-  uint8_t day = bcdToDec(Wire.read());
-  uint8_t month = Wire.read();           //Gets current month
-  uint8_t year = bcdToDec(Wire.read());  //Gets current year
-  if (month & 0x80) year += 100;
-  month = bcdToDec(month & 0x1F);
-  Wire.beginTransmission(0x68);
-  Wire.write(0x07);
-  Wire.endTransmission();
-  Wire.requestFrom(0x68, 4);
-  uint8_t almSecond = bcdToDec(Wire.read() & 0x7F);
-  uint8_t almMinute = bcdToDec(Wire.read() & 0x7F);
-  uint8_t almHour = bcdToDec(Wire.read() & 0x3F);
-  uint8_t almDay = bcdToDec(Wire.read() & 0x3F);
-
-  uint64_t now = unixFromDate(second, minute, hour, day, month, year);
-  uint64_t alm = unixFromDate(almSecond, almMinute, almHour, almDay, month, year);
-  if (alm < now) {
-    month++;
-    if (month > 12) {
-      month = 0;
-      year++;
-    }
-    alm = unixFromDate(almSecond, almMinute, almHour, almDay, month, year);
-  }
-  return alm;
+uint64_t UnixRTC::getAlarm1Time() {
+  UNIXRTC_CALL("getAlarm1Time");
+  uint8_t regs[11];
+  if (!readRegisters(0x00, regs, 11)) return 0;  //Time and Alarm 1 (0x00-0x0A) in one burst
+  uint8_t day;
+  uint8_t month;
+  uint8_t year;
+  uint64_t now = decodeTime(regs, day, month, year);
+  return decodeAlarm(regs + 0x07, true, now);
+}
+
+uint8_t UnixRTC::getAlarm1Mode() {
+  UNIXRTC_CALL("getAlarm1Mode");
+  uint8_t alarm[4];
+  if (!readRegisters(0x07, alarm, 4)) return RTC_ALARM_UNKNOWN;
+  return decodeAlarmMode(alarm, true);
 }
-void UnixRTC::setAlarm1Time(uint64_t unix) {
+
+bool UnixRTC::setAlarm1Time(uint64_t unix, uint8_t mode) {
+  UNIXRTC_CALL("setAlarm1Time");
+  if (mode > RTC_ALARM_PER_MONTH) return false;
+  if (unix < 946684800 || unix >= 7258118400) return false;  //Y2000-Y2199, same as setTime()
   uint8_t second;
   uint8_t minute;
   uint8_t hour;
-  uint8_t dayOfWeek;  //not used
+  uint8_t dayOfWeek;
   uint8_t day;
   uint8_t month;  //not used
   uint8_t year;   //not used
   dateFromUnix(unix, second, minute, hour, dayOfWeek, day, month, year);
-  Wire.beginTransmission(0x68);
-  Wire.write(0x7);
-  Wire.write(decToBcd(second));
-  Wire.write(decToBcd(minute));
-  Wire.write(decToBcd(hour));
-  Wire.write(decToBcd(day));
-  Wire.endTransmission();
+  uint8_t alarm[4] = { decToBcd(second), decToBcd(minute), decToBcd(hour), decToBcd(day) };
+  encodeAlarmMode(alarm, 4, mode, dayOfWeek);
+  return writeRegisters(0x07, alarm, 4);
 }
 
 bool UnixRTC::alm1Tripped(bool clearFlag) {
-  Wire.beginTransmission(0x68);
-  Wire.write(0xF);
-  Wire.endTransmission();
-  Wire.requestFrom(0x68, 1);
-  uint8_t status = Wire.read();
+  UNIXRTC_CALL("alm1Tripped");
+  uint8_t status;
+  if (!readStatus(status)) return false;  //Alarm flags are volatile, always read from the RTC
   bool tripped = status & 0x01;
   if (clearFlag && tripped) {
-    status &= 0xFE;
-    Wire.beginTransmission(0x68);
-    Wire.write(0xF);
-    Wire.write(status);
-    Wire.endTransmission();
+    writeStatus((status | 0x03) & 0xFE);  //The other flag is written as 1 so it can't be lost if it trips in between
   }
   return tripped;
 }
@@ -361,109 +972,63 @@ void UnixRTC::clearAlm1() {
 }
 
 bool UnixRTC::alm1InterrptEnabled() {
-  Wire.beginTransmission(0x68);
-  Wire.write(0xE);
-  Wire.endTransmission();
-  Wire.requestFrom(0x68, 1);
-  return Wire.read() & 0x01;
+  UNIXRTC_CALL("alm1InterrptEnabled");
+  uint8_t control;
+  return readControl(control) && (control & 0x01);
 }
 
 void UnixRTC::enableAlm1Interrupt(bool enable) {
-  Wire.beginTransmission(0x68);
-  Wire.write(0xE);
-  Wire.endTransmission();
-  Wire.requestFrom(0x68, 1);
-  uint8_t control = Wire.read();
-  uint8_t newControl = control;
-  if (enable) {
-    newControl |= 1;
-  } else {
-    newControl &= 0xFE;
-  }
-  if (newControl != control) {
-    Wire.beginTransmission(0x68);
-    Wire.write(0xE);
-    Wire.write(newControl);
-    Wire.endTransmission();
-  }
+  UNIXRTC_CALL("enableAlm1Interrupt");
+  updateControl(0x01, enable ? 0x01 : 0);
 }
 
 void UnixRTC::disableAlm1Interrupt() {
   enableAlm1Interrupt(false);
 }
 
-uint64_t UnixRTC::getAlarm2Time() {  //This function assumes the alarm was set by this library, for simplicity
-  Wire.beginTransmission(0x68);
-  Wire.write(0x00);
-  Wire.endTransmission();
-  Wire.requestFrom(0x68, 7);
-  uint8_t second = bcdToDec(Wire.read());
-  uint8_t minute = bcdToDec(Wire.read());
-  uint8_t rawHour = Wire.read() & 0x7F;
-  bool Y2100handled = rawHour & 0x40;  //Has the Y2100 bug already been handled? (Uses the AM/PM flag as memory due to RTC limitations)
-  uint8_t hour = bcdToDec(rawHour & 0x3F);
-  if (Y2100handled) {  //12H time, convert to 24h (Side effect of using the AM/PM flag as memory)
-    bool isPM = rawHour & 0x20;
-    hour = bcdToDec(rawHour & 0x1F);
-    if (hour > 11) hour = 0;
-    if (isPM) hour += 12;
-  }
-  Wire.read();  //DoW not needed
-  uint8_t day = bcdToDec(Wire.read());
-  uint8_t month = Wire.read();           //Gets current month
-  uint8_t year = bcdToDec(Wire.read());  //Gets current year
-  if (month & 0x80) year += 100;
-  month = bcdToDec(month & 0x1F);
-  Wire.beginTransmission(0x68);
-  Wire.write(0x0B);
-  Wire.endTransmission();
-  Wire.requestFrom(0x68, 3);
-  uint8_t almMinute = bcdToDec(Wire.read() & 0x7F);
-  uint8_t almHour = bcdToDec(Wire.read() & 0x3F);
-  uint8_t almDay = bcdToDec(Wire.read() & 0x3F);
-  uint64_t now = unixFromDate(second, minute, hour, day, month, year);
-  uint64_t alm = unixFromDate(0, almMinute, almHour, almDay, month, year);
-  if (alm < now) {
-    month++;
-    if (month > 12) {
-      month = 0;
-      year++;
-    }
-    alm = unixFromDate(0, almMinute, almHour, almDay, month, year);
-  }
-  return alm;
+uint64_t UnixRTC::getAlarm2Time() {
+  UNIXRTC_CALL("getAlarm2Time");
+  uint8_t regs[14];
+  if (!readRegisters(0x00, regs, 14)) return 0;  //Time and Alarm 2 (0x00-0x0D) in one burst
+  uint8_t day;
+  uint8_t month;
+  uint8_t year;
+  uint64_t now = decodeTime(regs, day, month, year);
+  return decodeAlarm(regs + 0x0B, false, now);
+}
+
+uint8_t UnixRTC::getAlarm2Mode() {
+  UNIXRTC_CALL("getAlarm2Mode");
+  uint8_t alarm[3];
+  if (!readRegisters(0x0B, alarm, 3)) return RTC_ALARM_UNKNOWN;
+  return decodeAlarmMode(alarm, false);
 }
 
-void UnixRTC::setAlarm2Time(uint64_t unix) {
+
+bool UnixRTC::setAlarm2Time(uint64_t unix, uint8_t mode) {
+  UNIXRTC_CALL("setAlarm2Time");
+  if (mode < RTC_ALARM_PER_MINUTE || mode > RTC_ALARM_PER_MONTH) return false;  //Alarm 2 has no seconds register
+  if (unix < 946684800 || unix >= 7258118400) return false;  //Y2000-Y2199, same as setTime()
   uint8_t second;  //not used
   uint8_t minute;
   uint8_t hour;
-  uint8_t dayOfWeek;  //not used
+  uint8_t dayOfWeek;
   uint8_t day;
   uint8_t month;  //not used
   uint8_t year;   //not used
   dateFromUnix(unix, second, minute, hour, dayOfWeek, day, month, year);
-  Wire.beginTransmission(0x68);
-  Wire.write(0xB);
-  Wire.write(decToBcd(minute));
-  Wire.write(decToBcd(hour));
-  Wire.write(decToBcd(day));
-  Wire.endTransmission();
+  uint8_t alarm[3] = { decToBcd(minute), decToBcd(hour), decToBcd(day) };
+  encodeAlarmMode(alarm, 3, mode, dayOfWeek);
+  return writeRegisters(0x0B, alarm, 3);
 }
 
 bool UnixRTC::alm2Tripped(bool clearFlag) {
-  Wire.beginTransmission(0x68);
-  Wire.write(0xF);
-  Wire.endTransmission();
-  Wire.requestFrom(0x68, 1);
-  uint8_t status = Wire.read();
+  UNIXRTC_CALL("alm2Tripped");
+  uint8_t status;
+  if (!readStatus(status)) return false;  //Alarm flags are volatile, always read from the RTC
   bool tripped = status & 0x02;
   if (clearFlag && tripped) {
-    status &= 0xFD;
-    Wire.beginTransmission(0x68);
-    Wire.write(0xF);
-    Wire.write(status);
-    Wire.endTransmission();
+    writeStatus((status | 0x03) & 0xFD);  //The other flag is written as 1 so it can't be lost if it trips in between
   }
   return tripped;
 }
@@ -472,31 +1037,14 @@ void UnixRTC::clearAlm2() {
 }
 
 bool UnixRTC::alm2InterrptEnabled() {
-  Wire.beginTransmission(0x68);
-  Wire.write(0xE);
-  Wire.endTransmission();
-  Wire.requestFrom(0x68, 1);
-  return Wire.read() & 0x02;
+  UNIXRTC_CALL("alm2InterrptEnabled");
+  uint8_t control;
+  return readControl(control) && (control & 0x02);
 }
 
 void UnixRTC::enableAlm2Interrupt(bool enable) {
-  Wire.beginTransmission(0x68);
-  Wire.write(0xE);
-  Wire.endTransmission();
-  Wire.requestFrom(0x68, 1);
-  uint8_t control = Wire.read();
-  uint8_t newControl = control;
-  if (enable) {
-    newControl |= 0x02;
-  } else {
-    newControl &= 0xFD;
-  }
-  if (newControl != control) {
-    Wire.beginTransmission(0x68);
-    Wire.write(0xE);
-    Wire.write(newControl);
-    Wire.endTransmission();
-  }
+  UNIXRTC_CALL("enableAlm2Interrupt");
+  updateControl(0x02, enable ? 0x02 : 0);
 }
 
 void UnixRTC::disableAlm2Interrupt() {
@@ -504,24 +1052,14 @@ void UnixRTC::disableAlm2Interrupt() {
 }
 
 uint16_t UnixRTC::getSQWFreq() {
-  Wire.beginTransmission(0x68);
-  Wire.write(0xE);
-  Wire.endTransmission();
-  Wire.requestFrom(0x68, 1);
-  uint8_t rawFreq = (Wire.read() >> 3) & 0x3;
-  switch (rawFreq) {
-    case 0:
-      return 1;
-    case 1:
-      return 1024;
-    case 2:
-      return 4096;
-    default:
-      return 8192;
-  }
+  UNIXRTC_CALL("getSQWFreq");
+  uint8_t control;
+  if (!readControl(control)) return 0;
+  return decodeSQWFreq(control);
 }
 
 bool UnixRTC::setSQWFreq(uint16_t freq) {
+  UNIXRTC_CALL("setSQWFreq");
   uint8_t freqBits = 0;
   switch (freq) {
     case 1:
@@ -539,80 +1077,575 @@ bool UnixRTC::setSQWFreq(uint16_t freq) {
     default:
       return false;
   }
-  freqBits <<= 3;
-  Wire.beginTransmission(0x68);
-  Wire.write(0x0E);
-  Wire.endTransmission();
-  Wire.requestFrom(0x68, 1);
-  uint8_t oldControl = Wire.read();
-  freqBits |= (oldControl & 0xE7);
-  if (freqBits != oldControl) {
-    Wire.beginTransmission(0x68);
-    Wire.write(0x0E);
-    Wire.write(freqBits);
-    Wire.endTransmission();
-  }
+  updateControl(0x18, freqBits << 3);
   return true;
 }
 
 bool UnixRTC::batteryBackedSQWEnabled() {
-  Wire.beginTransmission(0x68);
-  Wire.write(0x0E);
-  Wire.endTransmission();
-  Wire.requestFrom(0x68, 1);
-  return Wire.read() & 0x40;
+  UNIXRTC_CALL("batteryBackedSQWEnabled");
+  uint8_t control;
+  return readControl(control) && (control & 0x40);
 }
 
 void UnixRTC::enableBatteryBackedSQW(bool enable) {
-  Wire.beginTransmission(0x68);
-  Wire.write(0xE);
-  Wire.endTransmission();
-  Wire.requestFrom(0x68, 1);
-  uint8_t control = Wire.read();
-  uint8_t newControl = control;
-  if (enable) {
-    newControl |= 0x40;
-  } else {
-    newControl &= 0xBF;
-  }
-  if (newControl != control) {
-    Wire.beginTransmission(0x68);
-    Wire.write(0xE);
-    Wire.write(newControl);
-    Wire.endTransmission();
-  }
+  UNIXRTC_CALL("enableBatteryBackedSQW");
+  updateControl(0x40, enable ? 0x40 : 0);
 }
 void UnixRTC::disableBatteryBackedSQW() {
   enableBatteryBackedSQW(false);
 }
 
 bool UnixRTC::SQWEnabled() {
-  Wire.beginTransmission(0x68);
-  Wire.write(0x0E);
-  Wire.endTransmission();
-  Wire.requestFrom(0x68, 1);
-  return Wire.read() & 0x4;
+  UNIXRTC_CALL("SQWEnabled");
+  uint8_t control;
+  return readControl(control) && !(control & 0x4);  //INTCN clear selects the square wave
 }
 
 void UnixRTC::enableSQW(bool enable) {
-  Wire.beginTransmission(0x68);
-  Wire.write(0xE);
-  Wire.endTransmission();
-  Wire.requestFrom(0x68, 1);
-  uint8_t control = Wire.read();
-  uint8_t newControl = control;
-  if (enable) {
-    newControl |= 0x4;
+  UNIXRTC_CALL("enableSQW");
+  updateControl(0x4, enable ? 0 : 0x4);
+}
+void UnixRTC::disableSQW() {
+  enableSQW(false);
+}
+
+UnixRTC::Config UnixRTC::beginConfig() {
+  return Config(*this);
+}
+
+UnixRTC::Config::Config(UnixRTC& rtc)
+  : rtc(rtc), control(0), controlMask(0), status(0), statusMask(0), age(0), ageSet(false), valid(true) {}
+
+void UnixRTC::Config::setControl(uint8_t mask, uint8_t bits) {
+  control = (control & ~mask) | (bits & mask);
+  controlMask |= mask;
+}
+
+UnixRTC::Config& UnixRTC::Config::oscillator(bool enable) {
+  setControl(0x80, enable ? 0 : 0x80);
+  return *this;
+}
+
+UnixRTC::Config& UnixRTC::Config::enable32KHz(bool enable) {
+  status = enable ? 0x08 : 0;
+  statusMask = 0x08;
+  return *this;
+}
+
+UnixRTC::Config& UnixRTC::Config::sqw(uint16_t freq) {
+  sqwFreq(freq);
+  return enableSQW();
+}
+
+UnixRTC::Config& UnixRTC::Config::sqwFreq(uint16_t freq) {
+  switch (freq) {
+    case 1:
+      setControl(0x18, 0);
+      break;
+    case 1024:
+      setControl(0x18, 1 << 3);
+      break;
+    case 4096:
+      setControl(0x18, 2 << 3);
+      break;
+    case 8192:
+      setControl(0x18, 3 << 3);
+      break;
+    default:
+      valid = false;  //Reported by commit()
+  }
+  return *this;
+}
+
+UnixRTC::Config& UnixRTC::Config::enableSQW(bool enable) {
+  setControl(0x04, enable ? 0 : 0x04);
+  return *this;
+}
+
+UnixRTC::Config& UnixRTC::Config::batteryBackedSQW(bool enable) {
+  setControl(0x40, enable ? 0x40 : 0);
+  return *this;
+}
+
+UnixRTC::Config& UnixRTC::Config::alarm1Interrupt(bool enable) {
+  setControl(0x01, enable ? 0x01 : 0);
+  return *this;
+}
+
+UnixRTC::Config& UnixRTC::Config::alarm2Interrupt(bool enable) {
+  setControl(0x02, enable ? 0x02 : 0);
+  return *this;
+}
+
+UnixRTC::Config& UnixRTC::Config::agingOffset(int8_t offset) {
+  age = offset;
+  ageSet = true;
+  return *this;
+}
+
+bool UnixRTC::Config::commit() {
+  UNIXRTC_CALL("Config::commit");
+  if (!valid) return false;
+  uint8_t regs[3] = { 0, 0, 0 };
+  if (rtc.shadowEnabled) {
+    if (!rtc.shadowValid && (controlMask != 0xDF || !statusMask || rtc.keepStatus) && !rtc.resync()) return false;
+    regs[0] = rtc.shadowControl;
+    regs[1] = rtc.shadowStatus;
+  } else if (controlMask != 0xDF || !statusMask || rtc.keepStatus) {  //Only read when some bits are left unchanged
+    if (!rtc.readRegisters(0x0E, regs, 2)) return false;
+  }
+  regs[0] = ((regs[0] & ~controlMask) | control) & 0xDF;                          //CONV is never written back
+  regs[1] = (((regs[1] & ~statusMask) | status) & (0x08 | rtc.keepStatus)) | 0x83;  //Flags written as 1 are left unchanged by the RTC
+  regs[2] = age;
+  if (!rtc.writeRegisters(0x0E, regs, ageSet ? 3 : 2)) {
+    rtc.shadowValid = false;  //May or may not have been written
+    return false;
+  }
+  rtc.shadowControl = regs[0];
+  rtc.shadowStatus = (rtc.shadowStatus & 0x87) | (regs[1] & 0x78);
+  return true;
+}
+
+void UnixRTC::enableShadowRegisters(bool enable) {
+  shadowEnabled = enable;
+  shadowValid = false;  //Loaded on first use, or with resync()
+}
+void UnixRTC::disableShadowRegisters() {
+  enableShadowRegisters(false);
+}
+
+bool UnixRTC::shadowRegistersEnabled() {
+  return shadowEnabled;
+}
+
+void UnixRTC::enableIncrementalReads(bool enable) {
+  incremental = enable;
+  minuteValid = false;  //Loaded by the next full read
+}
+void UnixRTC::disableIncrementalReads() {
+  enableIncrementalReads(false);
+}
+bool UnixRTC::incrementalReadsEnabled() {
+  return incremental;
+}
+void UnixRTC::invalidateIncrementalReads() {
+  minuteValid = false;
+}
+
+bool UnixRTC::resync() {
+  UNIXRTC_CALL("resync");
+  uint8_t regs[2];
+  if (!readRegisters(0x0E, regs, 2)) return false;  //Control and status in one read
+  shadowControl = regs[0] & 0xDF;
+  shadowStatus = regs[1];
+  shadowValid = true;
+  return true;
+}
+
+uint8_t UnixRTC::beginSoftClock(bool useSQW) {
+  UNIXRTC_CALL("beginSoftClock");
+  softMode = RTC_SOFT_OFF;
+  if (useSQW) {
+    setSQWFreq(RTC_1Hz);
+    enableSQW();
+    uint32_t edges = softEdges;
+    uint32_t start = millis();
+    while (softEdges == edges && millis() - start < 1100) yield();  //Wait for a falling edge, the seconds register has just updated
+    if (softEdges != edges) {
+      uint64_t now = getTime();
+      if (!now) return softMode;
+      noInterrupts();
+      softBase = now - softEdges;
+      interrupts();
+      softMode = RTC_SOFT_SQW;
+      return softMode;
+    }
+  }
+  uint8_t first;
+  uint8_t second;
+  readRegisters(0x00, &first, 1);
+  uint32_t start = millis();
+  do {  //No SQW, find the start of a second by polling the seconds register
+    readRegisters(0x00, &second, 1);
+  } while (second == first && millis() - start < 1100);
+  softMillis = millis();
+  softBase = getTime();
+  if (!softBase) return softMode;
+  softMode = RTC_SOFT_POLLED;
+  return softMode;
+}
+
+void UnixRTC::endSoftClock() {
+  softMode = RTC_SOFT_OFF;
+}
+
+uint8_t UnixRTC::softClockMode() {
+  return softMode;
+}
+
+void UnixRTC::sqwEdge() {
+  softEdgeMicros = micros();
+  softEdges = softEdges + 1;
+}
+
+void UnixRTC::attachAlarmInterrupt(uint8_t pin, UnixRTCAlarmCallback callback, uint8_t alarms) {
+  UNIXRTC_CALL("attachAlarmInterrupt");
+  alarmMask = alarms & (RTC_ALM1 | RTC_ALM2);
+  alarmCallback = callback;
+  beginConfig().enableSQW(false).alarm1Interrupt(alarmMask & RTC_ALM1).alarm2Interrupt(alarmMask & RTC_ALM2).commit();
+  uint8_t status;
+  if (readStatus(status) && (status & alarmMask)) writeStatus((status | 0x03) & ~alarmMask);  //Stale flags would hold INT low and hide the next edge
+  alarmPin = pin;
+  pinMode(pin, INPUT_PULLUP);  //INT is open drain, active low
+  alarmPending = false;
+  attachInterrupt(digitalPinToInterrupt(pin), alarmISR, FALLING);
+  if (digitalRead(pin) == LOW) alarmPending = true;  //An alarm that fired in between has no edge left to catch
+}
+
+void UnixRTC::detachAlarmInterrupt() {
+  if (alarmPin == 0xFF) return;
+  detachInterrupt(digitalPinToInterrupt(alarmPin));
+  alarmPin = 0xFF;
+  alarmPending = false;
+}
+
+void UnixRTC::alarmISR() {
+  alarmPending = true;
+}
+
+uint8_t UnixRTC::service() {
+  if (!alarmPending) return 0;
+  UNIXRTC_CALL("service");  //Only counted when there is something to do
+  alarmPending = false;
+  minuteValid = false;  //The alarm may have woken the MCU from a sleep that stopped millis(), the cached minute can't be trusted
+  uint8_t status;
+  if (!readStatus(status)) {
+    alarmPending = true;  //Flags unknown, try again on the next call
+    return 0;
+  }
+  uint8_t fired = status & alarmMask;
+  if (fired) writeStatus((status | 0x03) & ~fired);  //Clears every fired flag in one write, a flag that trips in between is written as 1 and kept
+  if (alarmPin != 0xFF && digitalRead(alarmPin) == LOW) alarmPending = true;  //Still asserted, no new edge will come for it
+  if (fired && alarmCallback) alarmCallback(fired);
+  return fired;
+}
+
+uint32_t UnixRTC::softClock(uint64_t& second) {
+  if (softMode == RTC_SOFT_SQW) {
+    noInterrupts();
+    uint32_t edges = softEdges;
+    uint32_t edgeMicros = softEdgeMicros;
+    interrupts();
+    uint32_t elapsed = micros() - edgeMicros;
+    second = softBase + edges;
+    return elapsed > 999999 ? 999999 : elapsed;  //Never run into the next second if an edge is late
+  }
+  if (softMode == RTC_SOFT_OFF) {
+    second = getTime();
+    return 0;
+  }
+  uint32_t elapsed = millis() - softMillis;
+  if (elapsed >= 1000) {  //Once per second, check the extrapolation against the RTC
+    uint32_t whole = elapsed / 1000;
+    uint64_t expected = softBase + whole;
+    uint64_t now = getTime();
+    if (!now) now = expected;  //RTC unreadable, carry on extrapolating
+    if (now == expected) {
+      softMillis += whole * 1000;
+    } else if (now > expected) {  //millis() running slow, the RTC has only just ticked
+      softMillis = millis();
+    } else {  //millis() running fast, hold at the end of the RTC second
+      softMillis = millis() - 999;
+    }
+    softBase = now;
+    elapsed = millis() - softMillis;
+    if (elapsed > 999) elapsed = 999;
+  }
+  second = softBase;
+  return elapsed * 1000;
+}
+
+uint64_t UnixRTC::getTimeMs() {
+  UNIXRTC_CALL("getTimeMs");
+  uint64_t second;
+  uint32_t us = softClock(second);
+  return second * 1000 + us / 1000;
+}
+
+uint64_t UnixRTC::getTimeUs() {
+  UNIXRTC_CALL("getTimeUs");
+  uint64_t second;
+  uint32_t us = softClock(second);
+  return second * 1000000 + us;
+}
+
+uint8_t UnixRTC::lastError(bool clear) {
+  uint8_t last = error;
+  if (clear) error = RTC_OK;
+  return last;
+}
+
+void UnixRTC::setRetries(uint8_t count) {
+  retries = count;
+}
+
+void UnixRTC::setTimeBudget(uint32_t us) {
+  budget = us;
+  busControl->setTimeout(bus, us);
+}
+
+void UnixRTC::setBusRecovery(uint8_t sda, uint8_t scl) {
+  sdaPin = sda;
+  sclPin = scl;
+}
+
+bool UnixRTC::recoverBus() {  //Up to 9 clocks let a device finish the byte it thinks it is sending, the STOP then resets every device
+  if (sclPin == 0xFF) return false;
+  UNIXRTC_CALL("recoverBus");
+  busControl->end(bus);
+  pinMode(sdaPin, INPUT_PULLUP);
+  pinMode(sclPin, INPUT_PULLUP);
+  for (uint8_t i = 0; i < 9 && digitalRead(sdaPin) == LOW; i++) {
+    digitalWrite(sclPin, LOW);  //Open drain, the pins are only ever driven low
+    pinMode(sclPin, OUTPUT);
+    delayMicroseconds(5);
+    pinMode(sclPin, INPUT_PULLUP);
+    delayMicroseconds(5);
+  }
+  digitalWrite(sdaPin, LOW);  //STOP, SDA rising while SCL is high
+  pinMode(sdaPin, OUTPUT);
+  delayMicroseconds(5);
+  pinMode(sdaPin, INPUT_PULLUP);
+  delayMicroseconds(5);
+  bool released = digitalRead(sdaPin) == HIGH && digitalRead(sclPin) == HIGH;
+  busControl->begin(bus);  //Most cores go back to 100kHz here
+  return released;
+}
+
+#ifdef UNIXRTC_INSTRUMENT
+UnixRTCCallScope::UnixRTCCallScope(const char* name)
+  : stats(nullptr), start(0) {
+  if (activeStats) return;  //Nested, counted as part of the outer call
+  uint8_t slot = 0;
+  while (slot < UNIXRTC_STATS_SLOTS && callStats[slot].name && callStats[slot].name != name) slot++;  //Each call site passes the same literal, so pointers compare
+  if (slot < UNIXRTC_STATS_SLOTS) callStats[slot].name = name;
+  stats = &callStats[slot];
+  activeStats = stats;
+  start = micros();
+}
+
+UnixRTCCallScope::~UnixRTCCallScope() {
+  if (!stats) return;
+  uint32_t us = micros() - start;
+  stats->calls++;
+  stats->micros += us;
+  uint8_t bin = 0;
+  for (us >>= 6; us > 1 && bin < UNIXRTC_STATS_BINS - 1; us >>= 1) bin++;
+  if (stats->histogram[bin] != 0xFFFF) stats->histogram[bin]++;
+  activeStats = nullptr;
+}
+
+static void writeLE(Print& out, uint32_t value, uint8_t bytes) {
+  while (bytes--) {
+    out.write((uint8_t)value);
+    value >>= 8;
+  }
+}
+
+//Binary layout: 'U' 'R' 'S', version 1, bins, slot count, then per slot: name length, name, calls, transactions,
+//bytes written, bytes read (4 bytes each), retries, errors (2 bytes each), micros (4 bytes), bins x 2 bytes, all little endian
+void UnixRTC::dumpStats(Print& out, bool binary) {
+  uint8_t used = 0;
+  for (uint8_t slot = 0; slot <= UNIXRTC_STATS_SLOTS; slot++) {
+    if (callStats[slot].calls || callStats[slot].transactions) used++;
+  }
+  if (binary) {
+    out.write((const uint8_t*)"URS\x01", 4);
+    out.write((uint8_t)UNIXRTC_STATS_BINS);
+    out.write(used);
+  } else {
+    out.println("call calls transactions written read retries errors us histogram(<128us,x2...)");
+  }
+  for (uint8_t slot = 0; slot <= UNIXRTC_STATS_SLOTS; slot++) {
+    const UnixRTCCallStats& stats = callStats[slot];
+    if (!stats.calls && !stats.transactions) continue;
+    const char* name = slot < UNIXRTC_STATS_SLOTS ? stats.name : "other";
+    if (binary) {
+      uint8_t length = strlen(name);
+      out.write(length);
+      out.write((const uint8_t*)name, length);
+      writeLE(out, stats.calls, 4);
+      writeLE(out, stats.transactions, 4);
+      writeLE(out, stats.bytesWritten, 4);
+      writeLE(out, stats.bytesRead, 4);
+      writeLE(out, stats.retries, 2);
+      writeLE(out, stats.errors, 2);
+      writeLE(out, stats.micros, 4);
+      for (uint8_t bin = 0; bin < UNIXRTC_STATS_BINS; bin++) writeLE(out, stats.histogram[bin], 2);
+      continue;
+    }
+    const uint32_t counters[7] = { stats.calls, stats.transactions, stats.bytesWritten, stats.bytesRead, stats.retries, stats.errors, stats.micros };
+    out.print(name);
+    for (uint8_t i = 0; i < 7; i++) {
+      out.print(' ');
+      out.print((unsigned long)counters[i]);
+    }
+    for (uint8_t bin = 0; bin < UNIXRTC_STATS_BINS; bin++) {
+      out.print(bin ? ',' : ' ');
+      out.print((unsigned long)stats.histogram[bin]);
+    }
+    out.println();
+  }
+}
+
+const UnixRTCCallStats* UnixRTC::getStats(const char* name) {
+  if (!strcmp(name, "other")) return &callStats[UNIXRTC_STATS_SLOTS];
+  for (uint8_t slot = 0; slot < UNIXRTC_STATS_SLOTS && callStats[slot].name; slot++) {
+    if (!strcmp(callStats[slot].name, name)) return &callStats[slot];
+  }
+  return nullptr;
+}
+
+void UnixRTC::resetStats() {
+  memset(callStats, 0, sizeof(callStats));
+}
+#endif
+
+bool UnixRTC::readRegisters(uint8_t address, uint8_t* data, uint8_t length) {
+  return transfer(address, data, length, false);
+}
+
+bool UnixRTC::writeRegisters(uint8_t address, const uint8_t* data, uint8_t length) {
+  if (address < 0x07) minuteValid = false;  //Time registers changed (even if the write fails part way), the next read is a full one
+  return transfer(address, (uint8_t*)data, length, true);
+}
+
+bool UnixRTC::transfer(uint8_t address, uint8_t* data, uint8_t length, bool write) {
+  uint32_t start = budget ? micros() : 0;
+  uint32_t attemptStart = start;
+  for (uint8_t attempt = 0;; attempt++) {
+    uint8_t result = write ? writeOnce(address, data, length) : readOnce(address, data, length);
+    if (result == RTC_OK) return true;
+    error = result;
+    if (attempt >= retries) break;
+    COUNT_STATS(retries, 1);
+    if ((result == RTC_ERR_BUS || result == RTC_ERR_TIMEOUT) && sclPin != 0xFF) recoverBus();
+    if (budget) {
+      uint32_t now = micros();
+      if (now - start + (now - attemptStart) > budget) break;  //Only retry if another attempt as long as the last one still fits
+      attemptStart = now;
+    }
+  }
+  if (!write) memset(data, 0, length);  //Never leave stale bytes for a caller to decode
+  COUNT_STATS(errors, 1);
+  return false;
+}
+
+uint8_t UnixRTC::readOnce(uint8_t address, uint8_t* data, uint8_t length) {
+  uint8_t result = busTransfer(bus, deviceAddress, &address, 1, data, length, true);
+  COUNT_STATS(transactions, result == RTC_OK || result == RTC_ERR_SHORT_READ ? 2 : 1);  //Pointer write and read, counted apart as on Wire
+  COUNT_STATS(bytesWritten, 1);
+  COUNT_STATS(bytesRead, result == RTC_OK ? length : 0);
+  if (result) return result;
+  return plausible(address, data, length) ? RTC_OK : RTC_ERR_IMPLAUSIBLE;
+}
+
+uint8_t UnixRTC::writeOnce(uint8_t address, const uint8_t* data, uint8_t length) {
+  uint8_t result = busTransfer(bus, deviceAddress, &address, 1, (uint8_t*)data, length, false);
+  COUNT_STATS(transactions, 1);
+  COUNT_STATS(bytesWritten, 1 + length);
+  return result;
+}
+
+bool UnixRTC::plausible(uint8_t address, const uint8_t* data, uint8_t length) {  //A glitched read (e.g. all 0xFF) fails these long before it could decode to a wrong time
+  static const uint8_t masks[7] = { 0x7F, 0x7F, 0x3F, 0x07, 0x3F, 0x1F, 0xFF };  //Without CH, 12h, century and unused bits
+  static const uint8_t lowest[7] = { 0x00, 0x00, 0x00, 0x01, 0x01, 0x01, 0x00 };
+  static const uint8_t highest[7] = { 0x59, 0x59, 0x23, 0x07, 0x31, 0x12, 0x99 };  //Valid BCD compares in the same order as decimal
+  for (uint8_t reg = address; reg < 7 && reg < address + length; reg++) {
+    uint8_t value = data[reg - address] & masks[reg];
+    uint8_t low = lowest[reg];
+    uint8_t high = highest[reg];
+    if (reg == 2 && (data[reg - address] & 0x40)) {  //12h mode
+      value &= 0x1F;
+      low = 0x01;
+      high = 0x12;
+    }
+    if ((value & 0x0F) > 9 || value < low || value > high) return false;
+  }
+  if (address <= 4 && address + length >= 7) {  //Whole date read, the day must exist in that month
+    const uint8_t* date = data + 4 - address;
+    uint8_t month = bcdToDec(date[1] & 0x1F);
+    uint8_t year = bcdToDec(date[2]) + (date[1] & 0x80 ? 100 : 0);
+    uint8_t last = daysInMonth(month, year) + (month == 2 && year == 100 ? 1 : 0);  //The RTC's own calendar has a Feb 29 2100, corrected on decode
+    if (bcdToDec(date[0] & 0x3F) > last) return false;
+  }
+  return true;
+}
+
+bool UnixRTC::readBlock(uint8_t address, uint8_t* data, uint8_t length) {
+  while (length) {
+    uint8_t chunk = length < UNIXRTC_WIRE_BUFFER ? length : UNIXRTC_WIRE_BUFFER;
+    if (!readRegisters(address, data, chunk)) return false;
+    address += chunk;
+    data += chunk;
+    length -= chunk;
+  }
+  return true;
+}
+
+bool UnixRTC::writeBlock(uint8_t address, const uint8_t* data, uint8_t length) {
+  while (length) {
+    uint8_t chunk = length < UNIXRTC_WIRE_BUFFER - 1 ? length : UNIXRTC_WIRE_BUFFER - 1;  //One byte of the buffer holds the register address
+    if (!writeRegisters(address, data, chunk)) return false;
+    address += chunk;
+    data += chunk;
+    length -= chunk;
+  }
+  return true;
+}
+
+bool UnixRTC::readControl(uint8_t& control) {
+  if (shadowEnabled) {
+    if (!shadowValid && !resync()) return false;
+    control = shadowControl;
+    return true;
+  }
+  return readRegisters(0x0E, &control, 1);
+}
+
+void UnixRTC::writeControl(uint8_t control) {
+  control &= 0xDF;  //Never start a temperature conversion by writing back CONV
+  if (writeRegisters(0x0E, &control, 1)) {
+    shadowControl = control;
   } else {
-    newControl &= 0xFB;
+    shadowValid = false;  //May or may not have been written
   }
+}
+
+void UnixRTC::updateControl(uint8_t mask, uint8_t bits) {
+  uint8_t control;
+  if (shadowEnabled) {
+    if (!shadowValid && !resync()) return;
+    control = shadowControl;
+  } else if (!readRegisters(0x0E, &control, 1)) {
+    return;  //Never write back bits that weren't read
+  }
+  uint8_t newControl = (control & ~mask) | (bits & mask);
   if (newControl != control) {
-    Wire.beginTransmission(0x68);
-    Wire.write(0xE);
-    Wire.write(newControl);
-    Wire.endTransmission();
+    writeControl(newControl);
   }
 }
-void UnixRTC::disableSQW() {
-  enableSQW(false);
+
+bool UnixRTC::readStatus(uint8_t& status) {
+  if (!readRegisters(0x0F, &status, 1)) return false;
+  if (shadowValid) shadowStatus = status;
+  return true;
+}
+
+void UnixRTC::writeStatus(uint8_t status) {
+  if (writeRegisters(0x0F, &status, 1)) {
+    shadowStatus = (shadowStatus & 0x87) | (status & 0x78);  //Only the configuration bits are known after a write, the flags stay volatile
+  } else {
+    shadowValid = false;
+  }
 }
@@ -37,47 +37,205 @@
 #ifndef UnixRTC_H
 #define UnixRTC_H
 
-#include "Arduino.h"  //Arduino core libraries
-#include "Wire.h"     //Arduino builtin I2C library
+#include "Arduino.h"           //Arduino core libraries
+#include "UnixRTCTransport.h"  //I2C transports (TwoWire by default)
+
+class UnixRTCTempHistory;
 
 #define RTC_1Hz 1
 #define RTC_1KHz 1024
 #define RTC_4KHz 4096
 #define RTC_8KHz 8192
 
+#define UNIXRTC_WIRE_BUFFER 32  //Bytes per I2C transaction, the smallest Wire buffer among the Arduino cores
+#define UNIXRTC_SET_MARGIN_US 20000  //Time setTimeMs() allows itself to prepare the write before the whole second it aims for
+#define UNIXRTC_INCREMENTAL_MS 58000  //Longest gap between incremental reads, under a minute so a seconds read alone still shows whether the minute changed
+
+//#define UNIXRTC_INSTRUMENT  //Counts I2C traffic and time per public call (see dumpStats()), compiled out entirely unless defined here or in the build flags
+
+#define RTC_ALARM_PER_SECOND 0  //Alarm 1 only, trips every second
+#define RTC_ALARM_PER_MINUTE 1  //Trips when the seconds match (Alarm 2: every minute at :00)
+#define RTC_ALARM_PER_HOUR 2    //Trips when the minutes (and seconds) match
+#define RTC_ALARM_PER_DAY 3     //Trips when the hours, minutes (and seconds) match
+#define RTC_ALARM_PER_WEEK 4    //Trips on the same day of the week and time
+#define RTC_ALARM_PER_MONTH 5   //Trips on the same date and time (default)
+#define RTC_ALARM_UNKNOWN 0xFF  //Returned by getAlarm1Mode()/getAlarm2Mode() when the alarm couldn't be read
+
+#define RTC_ISO8601_LENGTH 30  //Buffer size for any formatISO8601()/formatISO8601Ms() output, including the terminator
+
+#define RTC_ALM1 0x01  //Alarm 1 bit in attachAlarmInterrupt() masks and callbacks
+#define RTC_ALM2 0x02  //Alarm 2 bit in attachAlarmInterrupt() masks and callbacks
+
+#define RTC_TEMP_IDLE 0     //No conversion started
+#define RTC_TEMP_PENDING 1  //Conversion running
+#define RTC_TEMP_READY 2    //Conversion finished, readTemp() returns the new value
+#define RTC_TEMP_TIMEOUT 3  //Conversion did not finish in time, readTemp() returns the previous value
+
+#define RTC_SOFT_OFF 0     //Software clock stopped
+#define RTC_SOFT_SQW 1     //Software clock disciplined by the 1Hz SQW edge
+#define RTC_SOFT_POLLED 2  //Software clock re-read from the RTC once per second
+
+struct UnixRTCSnapshot {          //Every RTC register from a single burst read, decoded once
+  uint8_t regs[19];                //Raw registers 0x00-0x12
+  uint64_t time;                   //Unix time (with Y2100 correction)
+  uint64_t alarm1;                 //Unix time at which Alarm 1 will trip
+  uint64_t alarm2;                 //Unix time at which Alarm 2 will trip
+  uint8_t alarm1Mode;              //RTC_ALARM_* repeat mode of Alarm 1
+  uint8_t alarm2Mode;              //RTC_ALARM_* repeat mode of Alarm 2
+  bool timeValid;                  //Oscillator stop flag clear
+  bool oscillatorEnabled;          //Oscillator keeps running on battery (EOSC clear)
+  bool output32KHzEnabled;         //EN32kHz bit
+  bool batteryBackedSQWEnabled;    //BBSQW bit
+  bool SQWEnabled;                 //SQW/INT mode (True = SQW, False = INT)
+  uint16_t sqwFreq;                //SQW frequency in Hz
+  bool alm1Tripped;                //A1F flag
+  bool alm2Tripped;                //A2F flag
+  bool alm1InterruptEnabled;       //A1IE bit
+  bool alm2InterruptEnabled;       //A2IE bit
+  bool converting;                 //CONV bit, user temperature conversion running
+  bool busy;                       //BSY bit, any temperature conversion running
+  int8_t agingOffset;              //Crystal aging offset
+  int16_t temp;                    //Temperature (in x4 deg C)
+  uint8_t error;                   //RTC_OK, or the RTC_ERR_* that stopped the read (the other fields are then not updated)
+};
+
+typedef void (*UnixRTCAlarmCallback)(uint8_t alarms);  //Called from service() with the RTC_ALM1/RTC_ALM2 bits of the alarms that fired
+
+#ifdef UNIXRTC_INSTRUMENT
+#ifndef UNIXRTC_STATS_SLOTS
+#define UNIXRTC_STATS_SLOTS 12  //Calls tracked separately, the first ones made get a slot and the rest count as "other"
+#endif
+#define UNIXRTC_STATS_BINS 12   //Latency histogram bins
+
+struct UnixRTCCallStats {                  //I2C traffic and time of one public call (nested calls count towards the outermost one)
+  const char* name;                        //Call name, "other" for anything without a slot
+  uint32_t calls;
+  uint32_t transactions;                   //I2C transactions (a register read is two, the pointer write and the read)
+  uint32_t bytesWritten;                   //Including register address bytes
+  uint32_t bytesRead;
+  uint16_t retries;                        //Attempts repeated after a failure
+  uint16_t errors;                         //Transactions that still failed after their retries
+  uint32_t micros;                         //Total time spent in the call
+  uint16_t histogram[UNIXRTC_STATS_BINS];  //Calls by duration: bin 0 under 128us, bin n from 64us << n up to 128us << n, the last bin open ended
+};
+
+class UnixRTCCallScope {  //Attributes the traffic and time of one call to its slot, declared with UNIXRTC_CALL()
+public:
+  UnixRTCCallScope(const char* name);
+  ~UnixRTCCallScope();
+private:
+  UnixRTCCallStats* stats;  //nullptr when nested in another call
+  uint32_t start;
+};
+#define UNIXRTC_CALL(name) UnixRTCCallScope unixrtcCallScope(name)
+#else
+#define UNIXRTC_CALL(name)
+#endif
+
+struct UnixRTCDateFields {  //Structure of arrays for the batch conversions, each pointer holds n entries
+  uint8_t* second;          //0-59
+  uint8_t* minute;          //0-59
+  uint8_t* hour;            //0-23
+  uint8_t* dayOfWeek;       //0-6, 0 being Sunday (ignored by fromCalendar)
+  uint8_t* day;             //1-31
+  uint8_t* month;           //1-12
+  uint8_t* year;            //0-199, years since 2000
+};
+
+struct UnixRTCDateTime {  //Broken-down UTC time, read and written straight from the time registers (7 bytes)
+  uint8_t second;         //0-59
+  uint8_t minute;         //0-59
+  uint8_t hour;           //0-23
+  uint8_t dayOfWeek;      //0-6, 0 being Sunday (from the RTC's day register, worked out from the date when setting)
+  uint8_t day;            //1-31
+  uint8_t month;          //1-12
+  uint8_t year;           //0-199, years since 2000
+};
+
 class UnixRTC {  //RTC class
+  friend class UnixRTCAsync;
+  friend class UnixRTCScheduler;
+  friend class UnixRTCTimeZone;
+  friend class UnixRTCLog;
+  friend class UnixRTCDiscipline;
+  template <class Chip, bool DS3231Family>
+  friend class UnixRTCDevice;
 public:
-  UnixRTC(void);                                    //Constructor
+  class Config {  //Collects control/status/aging changes and writes them in one transaction, see beginConfig()
+  public:
+    Config(UnixRTC& rtc);
+    Config& oscillator(bool enable = true);        //Same as enableOscillator()
+    Config& enable32KHz(bool enable = true);       //Same as enable32KHzOut()
+    Config& sqw(uint16_t freq);                    //Sets the SQW frequency in Hz and enables the SQW output
+    Config& sqwFreq(uint16_t freq);                //Sets the SQW frequency in Hz only
+    Config& enableSQW(bool enable = true);         //Same as enableSQW()
+    Config& batteryBackedSQW(bool enable = true);  //Same as enableBatteryBackedSQW()
+    Config& alarm1Interrupt(bool enable = true);   //Same as enableAlm1Interrupt()
+    Config& alarm2Interrupt(bool enable = true);   //Same as enableAlm2Interrupt()
+    Config& agingOffset(int8_t age);               //Same as setAgingOffset()
+    bool commit();                                 //Writes 0x0E-0x0F (0x0E-0x10 with an aging offset) at once, false on an invalid frequency
+  private:
+    UnixRTC& rtc;
+    uint8_t control;      //New control bits
+    uint8_t controlMask;  //Control bits that were set
+    uint8_t status;       //New status bits
+    uint8_t statusMask;   //Status bits that were set
+    int8_t age;
+    bool ageSet;
+    bool valid;
+    void setControl(uint8_t mask, uint8_t bits);
+  };
+
+#ifndef UNIXRTC_NO_WIRE
+  UnixRTC(void);                                    //Constructor, RTC at 0x68 on Wire
+  UnixRTC(TwoWire& wire, uint8_t address = 0x68);   //RTC on another TwoWire (e.g. Wire1) or at another address
+#endif
+  template <class Bus>
+  UnixRTC(Bus& bus, uint8_t address = 0x68)         //RTC behind any transport (see UnixRTCTransport.h), which must outlive it
+    : UnixRTC(&bus, &UnixRTCBinding<Bus>::transfer, &UnixRTCBinding<Bus>::control, address) {}
+  UnixRTC(const UnixRTC&) = delete;                 //Not copyable, the TwoWire constructors point the transport at this object's own member
+  UnixRTC(UnixRTC&) = delete;                       //Keeps a non-const copy from picking the transport constructor
+  UnixRTC& operator=(const UnixRTC&) = delete;
   void begin();                                     //Initializes I2C bus
-  uint64_t getTime();                              //Reads unix time from RTC (with Y2100 correction)
-  bool setTime(uint64_t unix);                      //Writes unix time to RTC
+  uint64_t getTime();                              //Reads unix time from RTC (with Y2100 correction), 0 if it couldn't be read (see lastError())
+  bool setTime(uint64_t unix);                      //Writes unix time to RTC, false if out of range or the write failed
+  bool setTimeMs(uint64_t unixMs);                  //Writes unix time in ms, waiting (up to a second) to write the seconds register on a whole second with the bus latency taken out
+  bool setTimeAt(uint64_t unixMs, uint32_t referenceMicros);  //Same as setTimeMs(), with unixMs the time when micros() was referenceMicros (e.g. when an NTP reply arrived)
+  bool getDateTime(UnixRTCDateTime& dt);            //Reads the time registers into dt (with Y2100 correction) without going through unix time, false if they couldn't be read
+  bool setDateTime(const UnixRTCDateTime& dt);      //Writes dt to the time registers (dayOfWeek is ignored), false if dt is invalid or the write failed
   float getTemp(bool force = false);                //Returns the RTC temperature as a float (in deg C)
   int16_t getTempInt(bool force = false);           //Returns the RTC temperature as an int (in x4 deg C)
-  int8_t getAgingOffset();                          //Gets current crystal aging offset
+  bool startTempConversion(uint16_t timeoutMs = 1500);  //Starts a temperature conversion without waiting (joins a running one), false if one is already pending
+  uint8_t tempReady();                                  //Polls a pending conversion with one short read, returns RTC_TEMP_PENDING, RTC_TEMP_READY or RTC_TEMP_TIMEOUT
+  int16_t readTemp(uint32_t* ageMs = nullptr);          //Returns the last temperature read (in x4 deg C) without I2C traffic, and optionally its age
+  void trackTemp(UnixRTCTempHistory* history);          //Samples the automatic conversions into history (see UnixRTCTempHistory.h), nullptr to stop
+  int8_t getAgingOffset();                          //Gets current crystal aging offset, 0 if it couldn't be read (see lastError())
   void setAgingOffset(int8_t age = 0);              //Sets crystal aging offset
-  bool timeValid();                                 //Returns true if the time is valid
+  bool timeValid();                                 //Returns true if the time is valid, false if the status couldn't be read
   void assumeTimeValid();                           //Sets the Oscillator stop flag to 0 (used when setting time)
-  bool oscillatorEnabled();                         //Checks if the main oscillator is enabled
+  bool oscillatorEnabled();                         //Checks if the main oscillator is enabled, false if the control register couldn't be read
   void enableOscillator(bool enable = true);        //Enables or disables the oscillator when on battery backup
   void disableOscillator();                         //Same as enableOscillator(false);
   bool output32KHzEnabled();                        //Returns true if the 32KHz output is enabled
   void enable32KHzOut(bool enable = true);          //Enables or disables the 32KHz output
   void disable32KHzOut();                           //Same as enable32KHzOut(false);
   uint64_t getAlarm1Time();                         //Gets the unix time at which Alarm 1 will trip
-  void setAlarm1Time(uint64_t unix);                //Changes the time at which Alarm 1 will trip
+  bool setAlarm1Time(uint64_t unix, uint8_t mode = RTC_ALARM_PER_MONTH);  //Changes the time at which Alarm 1 will trip, repeating per mode (RTC_ALARM_*)
+  uint8_t getAlarm1Mode();                          //Gets the RTC_ALARM_* repeat mode of Alarm 1, RTC_ALARM_UNKNOWN if it couldn't be read
   bool alm1Tripped(bool clearFlag = false);         //Checks if the flag for Alarm 1 has tripped
   void clearAlm1();                                 //Clears the alarm flag, same as alm1Tripped(true);
   bool alm1InterrptEnabled();                       //Checks if the interrupt for alarm 1 is enabled
   void enableAlm1Interrupt(bool enable = true);     //Enables the alarm 1 interrupt
   void disableAlm1Interrupt();                      //Disables the alarm 1 interrupt
   uint64_t getAlarm2Time();                         //Gets the unix time at which Alarm 2 will trip
-  void setAlarm2Time(uint64_t unix);                //Changes the time at which Alarm 2 will trip
+  bool setAlarm2Time(uint64_t unix, uint8_t mode = RTC_ALARM_PER_MONTH);  //Changes the time at which Alarm 2 will trip, seconds are ignored (RTC_ALARM_PER_SECOND not supported)
+  uint8_t getAlarm2Mode();                          //Gets the RTC_ALARM_* repeat mode of Alarm 2, RTC_ALARM_UNKNOWN if it couldn't be read
   bool alm2Tripped(bool clearFlag = false);         //Checks if the flag for Alarm 2 has tripped
   void clearAlm2();                                 //Clears the alarm flag, same as alm2Tripped(true);
   bool alm2InterrptEnabled();                       //Checks if the interrupt for alarm 2 is enabled
   void enableAlm2Interrupt(bool enable = true);     //Enables the alarm 2 interrupt
   void disableAlm2Interrupt();                      //Disables the alarm 2 interrupt
-  uint16_t getSQWFreq();                            //Gets the current SQW frequency in Hz
+  uint16_t getSQWFreq();                            //Gets the current SQW frequency in Hz, 0 if it couldn't be read
   bool setSQWFreq(uint16_t freq);                   //Sets the SQW frequency in Hz, returns true on success
   bool batteryBackedSQWEnabled();                   //Returns true if the BBSQW function is enabled
   void enableBatteryBackedSQW(bool enable = true);  //Enables the BBSQW function
@@ -85,14 +243,143 @@ public:
   bool SQWEnabled();                                //Checks the SQW/INT mode (True = SQW, False = INT)
   void enableSQW(bool enable = true);               //Enables the SQW output
   void disableSQW();                                //Same as enableSQW(false);
+  void enableShadowRegisters(bool enable = true);   //Caches the control/status registers in RAM, setters then write without reading first
+  void disableShadowRegisters();                    //Same as enableShadowRegisters(false);
+  bool shadowRegistersEnabled();                    //Returns true if the control/status registers are cached
+  bool resync();                                    //Reloads the cached control/status registers from the RTC, false if they couldn't be read
+  void enableIncrementalReads(bool enable = true);  //getTime()/getDateTime() read only the seconds register while the cached minute is still current (the time must then only be set through this instance, and time spent with millis() stopped must invalidate the cache)
+  void disableIncrementalReads();                   //Same as enableIncrementalReads(false);
+  bool incrementalReadsEnabled();                   //Returns true if incremental reads are enabled
+  void invalidateIncrementalReads();                //Makes the next read a full one, call after a sleep that stopped millis() (service() does it for alarms)
+  Config beginConfig();                             //Starts a batched configuration change, finish with commit()
+  bool readSnapshot(UnixRTCSnapshot& snapshot);     //Reads and decodes every register in one I2C transaction, false (and snapshot.error set) if it failed
+  uint64_t getTime(const UnixRTCSnapshot& snapshot);                //The getters below return values from a snapshot without I2C traffic
+  float getTemp(const UnixRTCSnapshot& snapshot);
+  int16_t getTempInt(const UnixRTCSnapshot& snapshot);
+  int8_t getAgingOffset(const UnixRTCSnapshot& snapshot);
+  bool timeValid(const UnixRTCSnapshot& snapshot);
+  bool oscillatorEnabled(const UnixRTCSnapshot& snapshot);
+  bool output32KHzEnabled(const UnixRTCSnapshot& snapshot);
+  uint64_t getAlarm1Time(const UnixRTCSnapshot& snapshot);
+  uint8_t getAlarm1Mode(const UnixRTCSnapshot& snapshot);
+  bool alm1Tripped(const UnixRTCSnapshot& snapshot);
+  bool alm1InterrptEnabled(const UnixRTCSnapshot& snapshot);
+  uint64_t getAlarm2Time(const UnixRTCSnapshot& snapshot);
+  uint8_t getAlarm2Mode(const UnixRTCSnapshot& snapshot);
+  bool alm2Tripped(const UnixRTCSnapshot& snapshot);
+  bool alm2InterrptEnabled(const UnixRTCSnapshot& snapshot);
+  uint16_t getSQWFreq(const UnixRTCSnapshot& snapshot);
+  bool batteryBackedSQWEnabled(const UnixRTCSnapshot& snapshot);
+  bool SQWEnabled(const UnixRTCSnapshot& snapshot);
+  static void toCalendar(const uint64_t* in, const UnixRTCDateFields& out, size_t n);        //Converts n unix times (Y2000-Y2199) to calendar fields, no RTC needed
+  static void toCalendarSorted(const uint64_t* in, const UnixRTCDateFields& out, size_t n);  //Same as toCalendar(), faster when the input is in ascending order
+  static void fromCalendar(const UnixRTCDateFields& in, uint64_t* out, size_t n);            //Converts n sets of calendar fields to unix times
+  static void toDateTime(uint64_t unix, UnixRTCDateTime& dt);      //Converts unix time (Y2000-Y2199) to a UnixRTCDateTime
+  static uint64_t fromDateTime(const UnixRTCDateTime& dt);         //Converts a UnixRTCDateTime to unix time
+  static bool dateTimeValid(const UnixRTCDateTime& dt);            //Returns true if every field is in range and the day exists in that month (dayOfWeek is not checked)
+  static uint16_t dayOfYear(const UnixRTCDateTime& dt);            //1-366
+  static uint8_t isoWeek(const UnixRTCDateTime& dt, uint16_t* isoYear = nullptr);  //ISO 8601 week (1-53), isoYear gets the full year it belongs to (1999 for 2000-01-01)
+  static bool addSeconds(UnixRTCDateTime& dt, int32_t seconds);    //Moves dt by seconds (either way), false and dt unchanged if it would leave Y2000-Y2199
+  static bool addDays(UnixRTCDateTime& dt, int32_t days);          //Moves dt by whole days keeping the time of day, false and dt unchanged if it would leave Y2000-Y2199
+  static uint8_t formatISO8601(uint64_t unix, char* buffer, uint8_t size, int16_t offset = 0);      //Writes "2024-05-01T12:00:00Z" (or "+HH:MM" with an offset in minutes), returns the length or 0 if it doesn't fit
+  static uint8_t formatISO8601Ms(uint64_t unixMs, char* buffer, uint8_t size, int16_t offset = 0);  //Same with milliseconds ("2024-05-01T12:00:00.250Z"), e.g. from getTimeMs()
+  static bool parseISO8601(const char* text, uint64_t& unix, uint16_t* ms = nullptr);              //Parses an ISO-8601/RFC 3339 timestamp (Y2000-Y2199), false if malformed
+  uint8_t beginSoftClock(bool useSQW = true);       //Starts the I2C-free clock, returns the mode in use (RTC_SOFT_SQW or RTC_SOFT_POLLED, RTC_SOFT_OFF if the RTC couldn't be read)
+  void endSoftClock();                              //Stops the software clock
+  uint8_t softClockMode();                          //Returns RTC_SOFT_OFF, RTC_SOFT_SQW or RTC_SOFT_POLLED
+  void sqwEdge();                                   //Call from the SQW falling edge interrupt when using RTC_SOFT_SQW
+  uint64_t getTimeMs();                             //Unix time in milliseconds from the software clock
+  uint64_t getTimeUs();                             //Unix time in microseconds from the software clock
+  void attachAlarmInterrupt(uint8_t pin, UnixRTCAlarmCallback callback, uint8_t alarms = RTC_ALM1 | RTC_ALM2);  //INT mode with the alarms' interrupts enabled, the pin interrupt only sets a flag (one RTC per sketch)
+  void detachAlarmInterrupt();                      //Stops watching the INT pin, the alarm interrupts stay enabled
+  uint8_t service();                                //Call from loop(): without a pending interrupt returns 0 with no I2C traffic, otherwise clears and dispatches the fired alarms
+  uint8_t lastError(bool clear = true);             //Last RTC_ERR_* of a failed transaction (after its retries), RTC_OK if none since it was cleared
+  void setRetries(uint8_t retries);                 //Extra attempts after a failed transaction (default 2)
+  void setTimeBudget(uint32_t us);                  //Longest a transaction may take with its retries, 0 for no limit (default), also passed to the transport's setTimeout() (setWireTimeout() on cores with it)
+  void setBusRecovery(uint8_t sdaPin, uint8_t sclPin);  //Pins used by recoverBus(), which then also runs before retrying after a bus error or timeout
+  bool recoverBus();                                //Clocks SCL until a device holding SDA lets go and sends a STOP, false if the bus is still held or no pins are set
+#ifdef UNIXRTC_INSTRUMENT
+  static void dumpStats(Print& out, bool binary = false);  //Writes every call's counters and histogram as text (a line per call) or binary (see UnixRTC.cpp)
+  static const UnixRTCCallStats* getStats(const char* name);  //Counters of one call, e.g. "getAlarm1Time", nullptr if it has no slot
+  static void resetStats();                               //Clears every counter and frees the slots
+#endif
 private:
+  UnixRTC(void* bus, UnixRTCTransferFunction transfer, const UnixRTCBusControl* control, uint8_t address);                                            //Shared by the public constructors
+  void* bus;                                                                                                                                           //Transport object
+  UnixRTCTransferFunction busTransfer;                                                                                                                 //Its transfer(), the only bus call per transaction
+  const UnixRTCBusControl* busControl;                                                                                                                 //Its begin(), end() and setTimeout()
+  uint8_t deviceAddress;                                                                                                                               //7 bit I2C address of the RTC
+#ifndef UNIXRTC_NO_WIRE
+  UnixRTCWire wire;                                                                                                                                    //Transport used by the TwoWire constructors
+#endif
+  bool shadowEnabled;                                                                                                                                  //Control/status caching enabled
+  bool shadowValid;                                                                                                                                    //Cached registers hold the RTC contents
+  uint8_t shadowControl;                                                                                                                               //Cached control register (0x0E), CONV always 0
+  uint8_t shadowStatus;                                                                                                                                //Cached status register (0x0F), only EN32kHz is trusted
+  uint8_t keepStatus;                                                                                                                                  //Chip specific status bits that writes must preserve (DS3232 BB32kHz/CRATE)
+  bool incremental;                                                                                                                                    //Incremental reads enabled
+  bool minuteValid;                                                                                                                                    //minuteFields and minuteBase hold the current minute
+  UnixRTCDateTime minuteFields;                                                                                                                        //Fields of the last time read (with Y2100 correction)
+  uint64_t minuteBase;                                                                                                                                 //Unix time at second 0 of that minute
+  uint32_t minuteMillis;                                                                                                                               //millis() at the last time read
+  uint8_t tempState;                                                                                                                                   //Non-blocking conversion state
+  uint16_t tempTimeout;                                                                                                                                //Conversion timeout in ms
+  uint32_t tempStartMillis;                                                                                                                            //millis() when the conversion started
+  bool tempCached;                                                                                                                                     //lastTemp holds a reading
+  int16_t lastTemp;                                                                                                                                    //Last temperature read (in x4 deg C)
+  uint32_t lastTempMillis;                                                                                                                             //millis() when lastTemp was read
+  UnixRTCTempHistory* tempHistory;                                                                                                                     //Attached by trackTemp(), nullptr if none
+  uint32_t historyMillis;                                                                                                                              //millis() when tempHistory got its last sample
+  bool historyDue();                                                                                                                                   //tempHistory wants a sample
+  void cacheTemp(int16_t temp);                                                                                                                        //Updates lastTemp (and tempHistory when due)
+  uint8_t softMode;                                                                                                                                    //Software clock mode
+  uint64_t softBase;                                                                                                                                   //Unix time at softEdges == 0 (SQW) or at softMillis (polled)
+  volatile uint32_t softEdges;                                                                                                                         //SQW falling edges counted by sqwEdge()
+  volatile uint32_t softEdgeMicros;                                                                                                                    //micros() at the last SQW falling edge
+  uint32_t softMillis;                                                                                                                                 //millis() at the start of the second softBase (polled)
+  uint8_t alarmPin;                                                                                                                                    //Pin watched by attachAlarmInterrupt(), 0xFF if none
+  uint8_t alarmMask;                                                                                                                                   //RTC_ALM1/RTC_ALM2 bits handled by service()
+  UnixRTCAlarmCallback alarmCallback;
+  static volatile bool alarmPending;                                                                                                                   //Set by alarmISR(), cleared by service()
+  static void alarmISR();                                                                                                                              //INT falling edge
+  uint8_t error;                                                                                                                                       //Last RTC_ERR_*, see lastError()
+  uint8_t retries;                                                                                                                                     //Extra attempts per transaction
+  uint32_t budget;                                                                                                                                     //Microseconds per transaction with retries, 0 for no limit
+  uint8_t sdaPin;                                                                                                                                      //Bus recovery pins, 0xFF if not set
+  uint8_t sclPin;
+  uint32_t softClock(uint64_t& second);                                                                                                                //Current second and microseconds into it
+  bool readRegisters(uint8_t address, uint8_t* data, uint8_t length);                                                                                  //Burst reads consecutive registers (zeroed if the read fails)
+  bool writeRegisters(uint8_t address, const uint8_t* data, uint8_t length);                                                                           //Burst writes consecutive registers
+  bool transfer(uint8_t address, uint8_t* data, uint8_t length, bool write);                                                                          //One checked transaction, retried within the budget
+  uint8_t readOnce(uint8_t address, uint8_t* data, uint8_t length);                                                                                    //Single read attempt, returns RTC_OK or RTC_ERR_*
+  uint8_t writeOnce(uint8_t address, const uint8_t* data, uint8_t length);                                                                             //Single write attempt, returns RTC_OK or RTC_ERR_*
+  bool plausible(uint8_t address, const uint8_t* data, uint8_t length);                                                                                //BCD and range check of the time registers a read covers
+  bool readBlock(uint8_t address, uint8_t* data, uint8_t length);                                                                                      //readRegisters() split into Wire buffer sized bursts
+  bool writeBlock(uint8_t address, const uint8_t* data, uint8_t length);                                                                               //writeRegisters() split into Wire buffer sized bursts
+  bool readControl(uint8_t& control);                                                                                                                  //Reads the control register (from the cache if enabled), false if it couldn't be read
+  void writeControl(uint8_t control);                                                                                                                  //Writes the control register and updates the cache
+  void updateControl(uint8_t mask, uint8_t bits);                                                                                                      //Changes the masked control bits, writing only if they differ
+  bool readStatus(uint8_t& status);                                                                                                                    //Reads the status register from the RTC (flags are volatile), false if it couldn't be read
+  void writeStatus(uint8_t status);                                                                                                                    //Writes the status register and updates the cache
+  void decodeSnapshot(UnixRTCSnapshot& snapshot, uint8_t first, uint8_t last);                                                                        //Decodes the snapshot fields covered by registers first-last
+  uint64_t decodeTime(const uint8_t* regs, uint8_t& day, uint8_t& month, uint8_t& year);                                                              //Decodes registers 0x00-0x06 (with Y2100 correction)
+  void decodeDateTime(const uint8_t* regs, UnixRTCDateTime& dt);                                                                                      //Decodes registers 0x00-0x06 to fields (with Y2100 correction)
+  uint64_t decodeAlarm(const uint8_t* alarm, bool hasSeconds, uint64_t now);                                                                          //Next time an alarm trips, from its registers
+  uint8_t decodeAlarmMode(const uint8_t* alarm, bool hasSeconds);                                                                                      //Repeat mode from the mask bits
+  void encodeAlarmMode(uint8_t* alarm, uint8_t fields, uint8_t mode, uint8_t dayOfWeek);                                                               //Sets the mask bits for a repeat mode
+  int16_t decodeTemp(const uint8_t* regs);                                                                                                             //Decodes registers 0x11-0x12
+  uint16_t decodeSQWFreq(uint8_t control);                                                                                                             //SQW frequency from the control register
   uint8_t decToBcd(uint8_t i);                                                                                                                         //Converts decimal to BCD
   uint8_t bcdToDec(uint8_t i);                                                                                                                         //Converts BCD to decimal
   bool afterY2100bug(uint8_t day, uint8_t month, uint8_t year);                                                                                        //Returns true after Feb 28, 2100
-  void offsetDate(uint8_t& dayOfWeek, uint8_t& day, uint8_t& month, uint8_t& year);                                                                    //Offsets the date forward 1 day
-  void writeRawTime(uint8_t second, uint8_t minute, uint8_t hour, uint8_t dayOfWeek, uint8_t day, uint8_t month, uint8_t year);                        //Used internally for writing to the RTC and Y2100 correction
-  uint64_t unixFromDate(uint8_t second, uint8_t minute, uint8_t hour, uint8_t day, uint8_t month, uint8_t year);                                       //Internal conversion for unix time
-  void dateFromUnix(uint64_t unix, uint8_t& second, uint8_t& minute, uint8_t& hour, uint8_t& dayOfWeek, uint8_t& day, uint8_t& month, uint8_t& year);  //Internal conversion for unix time
+  void offsetDate(uint8_t& day, uint8_t& month, uint8_t& year);                                                                                        //Offsets the date forward 1 day (the day of week register already moved on)
+  bool writeRawTime(uint8_t second, uint8_t minute, uint8_t hour, uint8_t dayOfWeek, uint8_t day, uint8_t month, uint8_t year);                        //Used internally for writing to the RTC and Y2100 correction
+  bool writeDateTime(const UnixRTCDateTime& dt);                                                                                                       //Checks dt and writes it with its day of week, for setDateTime()
+  void encodeRawTime(uint8_t* regs, uint8_t second, uint8_t minute, uint8_t hour, uint8_t dayOfWeek, uint8_t day, uint8_t month, uint8_t year);         //Registers 0x00-0x06 for writeRawTime()
+  void timeWritten(uint64_t unix);                                                                                                                     //Soft clock, OSF and EOSC updates after a time write
+  static uint8_t formatTimestamp(uint64_t unix, int16_t ms, char* buffer, uint8_t size, int16_t offset);                                                  //Shared by formatISO8601() and formatISO8601Ms(), ms < 0 for none
+  static uint64_t unixFromDate(uint8_t second, uint8_t minute, uint8_t hour, uint8_t day, uint8_t month, uint8_t year);                                       //Internal conversion for unix time
+  static void dateFromUnix(uint64_t unix, uint8_t& second, uint8_t& minute, uint8_t& hour, uint8_t& dayOfWeek, uint8_t& day, uint8_t& month, uint8_t& year);  //Internal conversion for unix time
 };
 
 #endif
@@ -0,0 +1,91 @@
+#include "UnixRTCAsync.h"
+
+static const uint8_t readFirst[6] = { 0x00, 0x00, 0x00, 0x0E, 0x11, 0x00 };  //Register range of each RTC_READ_* request
+static const uint8_t readLast[6] = { 0x06, 0x0A, 0x0D, 0x0F, 0x12, 0x12 };
+
+#define MERGE_GAP 3  //Unrequested registers worth reading to save a transaction (pointer write, address and restart)
+
+UnixRTCAsync::UnixRTCAsync(UnixRTC& rtc)
+  : rtc(rtc), count(0), maxBurst(19), busy(false), first(0), last(0), next(0) {}
+
+bool UnixRTCAsync::read(uint8_t what, UnixRTCReadCallback callback, void* context) {
+  if (what > RTC_READ_ALL || count >= UNIXRTC_ASYNC_QUEUE) return false;
+  Request& request = queue[count++];
+  request.what = what;
+  request.running = false;
+  request.callback = callback;
+  request.context = context;
+  return true;
+}
+
+uint8_t UnixRTCAsync::pending() {
+  return count;
+}
+
+void UnixRTCAsync::setMaxBurst(uint8_t bytes) {
+  maxBurst = bytes ? bytes : 1;
+}
+
+bool UnixRTCAsync::poll() {
+  UNIXRTC_CALL("UnixRTCAsync::poll");
+  if (!busy) {
+    if (!count) return false;
+    startBurst();
+  }
+  uint8_t end = next + maxBurst - 1;
+  if (next == 0x00 && end < 0x06) end = 0x06;  //The RTC only latches the time registers for one read, never split them
+  if (end > last) end = last;
+  if (!rtc.readRegisters(next, snapshot.regs + next, end - next + 1)) {  //Already retried, the burst is given up and its callbacks see the error
+    finishBurst(false);
+    return count > 0;
+  }
+  next = end + 1;
+  if (next > last) finishBurst(true);
+  return count > 0;
+}
+
+void UnixRTCAsync::startBurst() {  //Picks the oldest request and merges every request near its range
+  first = readFirst[queue[0].what];
+  last = readLast[queue[0].what];
+  queue[0].running = true;
+  bool merged = true;
+  while (merged) {  //Repeat, each merge can bring further requests into reach
+    merged = false;
+    for (uint8_t i = 1; i < count; i++) {
+      if (queue[i].running) continue;
+      uint8_t f = readFirst[queue[i].what];
+      uint8_t l = readLast[queue[i].what];
+      if (f <= last + MERGE_GAP + 1 && l + MERGE_GAP + 1 >= first) {
+        if (f < first) first = f;
+        if (l > last) last = l;
+        queue[i].running = true;
+        merged = true;
+      }
+    }
+  }
+  next = first;
+  busy = true;
+}
+
+void UnixRTCAsync::finishBurst(bool read) {
+  busy = false;
+  if (read) {
+    rtc.decodeSnapshot(snapshot, first, last);
+  } else {
+    snapshot.error = rtc.error;
+  }
+  Request done[UNIXRTC_ASYNC_QUEUE];
+  uint8_t doneCount = 0;
+  uint8_t kept = 0;
+  for (uint8_t i = 0; i < count; i++) {  //Remove first, so callbacks can queue new reads
+    if (queue[i].running) {
+      done[doneCount++] = queue[i];
+    } else {
+      queue[kept++] = queue[i];
+    }
+  }
+  count = kept;
+  for (uint8_t i = 0; i < doneCount; i++) {
+    if (done[i].callback) done[i].callback(snapshot, done[i].context);
+  }
+}
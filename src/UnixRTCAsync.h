@@ -0,0 +1,53 @@
+/*
+  UnixRTCAsync, queued reads for UnixRTC that are completed piece by piece from poll()
+  - Part of the UnixRTC library: https://github.com/cornflowerenderman/UnixRTClib (MIT License, see UnixRTC.h)
+
+  Each poll() performs at most one short I2C step (a register pointer write plus a read of up to setMaxBurst() bytes),
+  so a cooperative scheduler is never blocked for a whole multi-register read. Queued reads of nearby registers are
+  merged into a single burst, and the completion callbacks receive a snapshot decoded for the registers they asked for.
+*/
+
+#ifndef UnixRTCAsync_h
+#define UnixRTCAsync_h
+
+#include "UnixRTC.h"
+
+#define RTC_READ_TIME 0    //Registers 0x00-0x06, snapshot.time
+#define RTC_READ_ALARM1 1  //Registers 0x00-0x0A, snapshot.time and snapshot.alarm1
+#define RTC_READ_ALARM2 2  //Registers 0x00-0x0D, snapshot.time and snapshot.alarm2
+#define RTC_READ_FLAGS 3   //Registers 0x0E-0x0F, control and status fields
+#define RTC_READ_TEMP 4    //Registers 0x11-0x12, snapshot.temp
+#define RTC_READ_ALL 5     //Registers 0x00-0x12, every field
+
+#define UNIXRTC_ASYNC_QUEUE 8  //Maximum number of queued reads
+
+typedef void (*UnixRTCReadCallback)(const UnixRTCSnapshot& snapshot, void* context);
+
+class UnixRTCAsync {  //Read queue for one RTC
+public:
+  UnixRTCAsync(UnixRTC& rtc);
+  bool read(uint8_t what, UnixRTCReadCallback callback, void* context = nullptr);  //Queues a RTC_READ_* request, false if the queue is full
+  bool poll();                                                                      //Performs one I2C step and runs finished callbacks, returns true while work remains
+  uint8_t pending();                                                                //Number of queued or running reads
+  void setMaxBurst(uint8_t bytes);                                                  //Bytes read per poll() (default 19, the time registers are always read together)
+private:
+  struct Request {
+    uint8_t what;
+    bool running;  //Part of the burst in progress
+    UnixRTCReadCallback callback;
+    void* context;
+  };
+  UnixRTC& rtc;
+  Request queue[UNIXRTC_ASYNC_QUEUE];
+  uint8_t count;
+  uint8_t maxBurst;
+  bool busy;       //A burst is in progress
+  uint8_t first;   //First register of the burst
+  uint8_t last;    //Last register of the burst
+  uint8_t next;    //Next register to read
+  UnixRTCSnapshot snapshot;
+  void startBurst();
+  void finishBurst(bool read);  //read is false if the burst failed
+};
+
+#endif
@@ -0,0 +1,272 @@
+/*
+  UnixRTCChips, compile-time chip selection for UnixRTC (DS3231, DS3232 and DS1307)
+  - Part of the UnixRTC library: https://github.com/cornflowerenderman/UnixRTClib (MIT License, see UnixRTC.h)
+
+  UnixRTCDevice<Chip> is picked by a traits type describing the chip's registers, capabilities and quirks.
+  Chips with the DS3231 register layout get the whole UnixRTC API, while the DS1307 gets a thin wrapper
+  with only the functions it has hardware for. Asking for a missing feature (alarms on a DS1307, SRAM on a
+  DS3231...) fails to compile with a static_assert instead of being checked at runtime, and as the wrappers
+  are inline, no flash is spent on functions that are never called.
+
+  Every chip shares the same time conversion and Y2100 leap year handling. The DS1307 has no century bit,
+  so the full year (0-199) is kept in its first SRAM byte (0x08) and the century is inferred from it on read.
+*/
+
+#ifndef UnixRTCChips_h
+#define UnixRTCChips_h
+
+#include "UnixRTC.h"
+
+#define RTC_32KHz 32768  //DS1307 only
+
+struct DS3231Chip {                              //Maxim DS3231
+  static constexpr uint8_t address = 0x68;       //Default I2C address
+  static constexpr bool hasDS3231Registers = true;  //Alarms, control, status, aging and temperature at 0x07-0x12
+  static constexpr bool hasCentury = true;       //Century bit in the month register
+  static constexpr bool hasAlarms = true;
+  static constexpr bool hasTemperature = true;
+  static constexpr bool hasAging = true;
+  static constexpr uint8_t sramStart = 0;        //First SRAM register
+  static constexpr uint8_t sramSize = 0;         //Bytes of user SRAM
+  static constexpr uint8_t keepStatus = 0x00;    //Chip specific status bits that must survive status writes
+};
+
+struct DS3232Chip {                              //Maxim DS3232, a DS3231 with 236 bytes of battery backed SRAM
+  static constexpr uint8_t address = 0x68;
+  static constexpr bool hasDS3231Registers = true;
+  static constexpr bool hasCentury = true;
+  static constexpr bool hasAlarms = true;
+  static constexpr bool hasTemperature = true;
+  static constexpr bool hasAging = true;
+  static constexpr uint8_t sramStart = 0x14;
+  static constexpr uint8_t sramSize = 236;
+  static constexpr uint8_t keepStatus = 0x70;    //BB32kHz, CRATE1 and CRATE0
+};
+
+struct DS1307Chip {                              //Maxim DS1307
+  static constexpr uint8_t address = 0x68;
+  static constexpr bool hasDS3231Registers = false;
+  static constexpr bool hasCentury = false;      //Year is kept in yearRegister instead
+  static constexpr bool hasAlarms = false;
+  static constexpr bool hasTemperature = false;
+  static constexpr bool hasAging = false;
+  static constexpr uint8_t sramStart = 0x09;     //0x08 is reserved by the library
+  static constexpr uint8_t sramSize = 55;
+  static constexpr uint8_t keepStatus = 0x00;
+  static constexpr uint8_t controlRegister = 0x07;  //OUT, SQWE and RS bits
+  static constexpr uint8_t yearRegister = 0x08;     //Full year (0-199) for century tracking
+};
+
+template <class Chip, bool DS3231Family = Chip::hasDS3231Registers>
+class UnixRTCDevice : public UnixRTC {  //DS3231 and DS3232, the full UnixRTC API
+public:
+#ifndef UNIXRTC_NO_WIRE
+  UnixRTCDevice(TwoWire& wire = Wire, uint8_t address = Chip::address)
+    : UnixRTC(wire, address) {
+    keepStatus = Chip::keepStatus;
+  }
+#endif
+  template <class Bus>
+  UnixRTCDevice(Bus& bus, uint8_t address = Chip::address)  //Any transport, see UnixRTCTransport.h
+    : UnixRTC(bus, address) {
+    keepStatus = Chip::keepStatus;
+  }
+  UnixRTCDevice(const UnixRTCDevice&) = delete;  //Not copyable, as UnixRTC
+  UnixRTCDevice(UnixRTCDevice&) = delete;
+  template <class C = Chip>
+  bool readSRAM(uint8_t offset, uint8_t* data, uint8_t length) {  //Reads length bytes of user SRAM, false if out of range or the read failed
+    static_assert(C::sramSize > 0, "This RTC has no user SRAM");
+    if (offset + length > C::sramSize) return false;
+    return readBlock(C::sramStart + offset, data, length);
+  }
+  template <class C = Chip>
+  bool writeSRAM(uint8_t offset, const uint8_t* data, uint8_t length) {  //Writes length bytes of user SRAM, false if out of range or the write failed
+    static_assert(C::sramSize > 0, "This RTC has no user SRAM");
+    if (offset + length > C::sramSize) return false;
+    return writeBlock(C::sramStart + offset, data, length);
+  }
+};
+
+template <class Chip>
+class UnixRTCDevice<Chip, false> {  //DS1307, time, oscillator, SQW and SRAM only
+public:
+#ifndef UNIXRTC_NO_WIRE
+  UnixRTCDevice(TwoWire& wire = Wire, uint8_t address = Chip::address)
+    : rtc(wire, address) {}
+#endif
+  template <class Bus>
+  UnixRTCDevice(Bus& bus, uint8_t address = Chip::address)  //Any transport, see UnixRTCTransport.h
+    : rtc(bus, address) {}
+  UnixRTCDevice(const UnixRTCDevice&) = delete;  //Not copyable, as UnixRTC
+  UnixRTCDevice(UnixRTCDevice&) = delete;
+  void begin() {  //Initializes I2C bus
+    rtc.begin();
+  }
+  uint8_t lastError(bool clear = true) {  //Same as UnixRTC::lastError()
+    return rtc.lastError(clear);
+  }
+  void setRetries(uint8_t retries) {  //Same as UnixRTC::setRetries()
+    rtc.setRetries(retries);
+  }
+  void setTimeBudget(uint32_t us) {  //Same as UnixRTC::setTimeBudget()
+    rtc.setTimeBudget(us);
+  }
+  void setBusRecovery(uint8_t sdaPin, uint8_t sclPin) {  //Same as UnixRTC::setBusRecovery()
+    rtc.setBusRecovery(sdaPin, sclPin);
+  }
+  bool recoverBus() {  //Same as UnixRTC::recoverBus()
+    return rtc.recoverBus();
+  }
+  uint64_t getTime() {  //Reads unix time from RTC (with Y2100 correction), 0 if it failed
+    UNIXRTC_CALL("DS1307 getTime");
+    UnixRTCDateTime dt;
+    if (!getDateTime(dt)) return 0;
+    return UnixRTC::fromDateTime(dt);
+  }
+  bool setTime(uint64_t unix) {  //Writes unix time to RTC, also starts the oscillator
+    UNIXRTC_CALL("DS1307 setTime");
+    if (unix < 946684800 || unix >= 7258118400) return false;  //Y2000-Y2199
+    UnixRTCDateTime dt;
+    UnixRTC::toDateTime(unix, dt);
+    return setDateTime(dt);
+  }
+  bool getDateTime(UnixRTCDateTime& dt) {  //Same as UnixRTC::getDateTime(), time registers and stored year in one burst
+    UNIXRTC_CALL("DS1307 getDateTime");
+    uint8_t regs[9];
+    if (!rtc.readRegisters(0x00, regs, 9)) return false;
+    uint8_t stored = regs[Chip::yearRegister] < 200 ? regs[Chip::yearRegister] : 0;  //Unset SRAM is treated as the 2000s
+    bool century = stored >= 100;
+    if (!century && rtc.bcdToDec(regs[6]) < stored) century = true;  //Year counter wrapped since the last read
+    if (century) regs[5] |= 0x80;                                    //Decoded as the century bit
+    rtc.decodeDateTime(regs, dt);
+    if (dt.year != regs[Chip::yearRegister]) rtc.writeRegisters(Chip::yearRegister, &dt.year, 1);
+    return true;
+  }
+  bool setDateTime(const UnixRTCDateTime& dt) {  //Same as UnixRTC::setDateTime(), also starts the oscillator
+    UNIXRTC_CALL("DS1307 setDateTime");
+    if (!rtc.writeDateTime(dt)) return false;  //Clears the Clock Halt bit
+    return rtc.writeRegisters(Chip::yearRegister, &dt.year, 1);
+  }
+  bool oscillatorEnabled() {  //Checks the Clock Halt bit, false if it couldn't be read
+    uint8_t second;
+    return rtc.readRegisters(0x00, &second, 1) && !(second & 0x80);
+  }
+  void enableOscillator(bool enable = true) {  //Starts or halts the clock (unlike the DS3231, this also stops it on main power)
+    uint8_t second;
+    if (!rtc.readRegisters(0x00, &second, 1)) return;
+    uint8_t newSecond = enable ? (second & 0x7F) : (second | 0x80);
+    if (newSecond != second) rtc.writeRegisters(0x00, &newSecond, 1);
+  }
+  void disableOscillator() {  //Same as enableOscillator(false);
+    enableOscillator(false);
+  }
+  bool timeValid() {  //The DS1307 has no oscillator stop flag, a halted clock is the closest equivalent
+    return oscillatorEnabled();
+  }
+  uint16_t getSQWFreq() {  //Gets the current SQW frequency in Hz, 0 if it couldn't be read
+    uint8_t control;
+    if (!rtc.readRegisters(Chip::controlRegister, &control, 1)) return 0;
+    static const uint16_t freqs[4] = { RTC_1Hz, RTC_4KHz, RTC_8KHz, RTC_32KHz };
+    return freqs[control & 0x03];
+  }
+  bool setSQWFreq(uint16_t freq) {  //Sets the SQW frequency in Hz (1, 4096, 8192 or 32768), returns true on success
+    uint8_t rs;
+    switch (freq) {
+      case RTC_1Hz:
+        rs = 0;
+        break;
+      case RTC_4KHz:
+        rs = 1;
+        break;
+      case RTC_8KHz:
+        rs = 2;
+        break;
+      case RTC_32KHz:
+        rs = 3;
+        break;
+      default:
+        return false;
+    }
+    updateControl(0x03, rs);
+    return true;
+  }
+  bool SQWEnabled() {  //Checks the SQWE bit, false if it couldn't be read
+    uint8_t control;
+    return rtc.readRegisters(Chip::controlRegister, &control, 1) && (control & 0x10);
+  }
+  void enableSQW(bool enable = true) {  //Enables the SQW output
+    updateControl(0x10, enable ? 0x10 : 0);
+  }
+  void disableSQW() {  //Same as enableSQW(false);
+    enableSQW(false);
+  }
+  void setOutputLevel(bool high) {  //Level of the SQW/OUT pin while the SQW output is disabled
+    updateControl(0x80, high ? 0x80 : 0);
+  }
+  bool readSRAM(uint8_t offset, uint8_t* data, uint8_t length) {  //Reads length bytes of user SRAM, false if out of range or the read failed
+    if (offset + length > Chip::sramSize) return false;
+    return rtc.readBlock(Chip::sramStart + offset, data, length);
+  }
+  bool writeSRAM(uint8_t offset, const uint8_t* data, uint8_t length) {  //Writes length bytes of user SRAM, false if out of range or the write failed
+    if (offset + length > Chip::sramSize) return false;
+    return rtc.writeBlock(Chip::sramStart + offset, data, length);
+  }
+  static void toCalendar(const uint64_t* in, const UnixRTCDateFields& out, size_t n) {  //Same as UnixRTC::toCalendar()
+    UnixRTC::toCalendar(in, out, n);
+  }
+  static void fromCalendar(const UnixRTCDateFields& in, uint64_t* out, size_t n) {  //Same as UnixRTC::fromCalendar()
+    UnixRTC::fromCalendar(in, out, n);
+  }
+  template <class C = Chip>
+  float getTemp(bool = false) {
+    static_assert(C::hasTemperature, "This RTC has no temperature sensor");
+    return 0;
+  }
+  template <class C = Chip>
+  int8_t getAgingOffset() {
+    static_assert(C::hasAging, "This RTC has no aging offset register");
+    return 0;
+  }
+  template <class C = Chip>
+  void setAgingOffset(int8_t = 0) {
+    static_assert(C::hasAging, "This RTC has no aging offset register");
+  }
+  template <class C = Chip>
+  uint64_t getAlarm1Time() {
+    static_assert(C::hasAlarms, "This RTC has no alarms");
+    return 0;
+  }
+  template <class C = Chip>
+  bool setAlarm1Time(uint64_t, uint8_t = RTC_ALARM_PER_MONTH) {
+    static_assert(C::hasAlarms, "This RTC has no alarms");
+    return false;
+  }
+  template <class C = Chip>
+  uint64_t getAlarm2Time() {
+    static_assert(C::hasAlarms, "This RTC has no alarms");
+    return 0;
+  }
+  template <class C = Chip>
+  bool setAlarm2Time(uint64_t, uint8_t = RTC_ALARM_PER_MONTH) {
+    static_assert(C::hasAlarms, "This RTC has no alarms");
+    return false;
+  }
+  template <class C = Chip>
+  void enable32KHzOut(bool = true) {
+    static_assert(C::hasDS3231Registers, "This RTC has no 32KHz output, use setSQWFreq(RTC_32KHz)");
+  }
+private:
+  UnixRTC rtc;  //Shared conversion, Y2100 handling and register access
+  void updateControl(uint8_t mask, uint8_t bits) {  //Changes the masked control bits, writing only if they differ
+    uint8_t control;
+    if (!rtc.readRegisters(Chip::controlRegister, &control, 1)) return;
+    uint8_t newControl = (control & ~mask) | bits;
+    if (newControl != control) rtc.writeRegisters(Chip::controlRegister, &newControl, 1);
+  }
+};
+
+typedef UnixRTCDevice<DS3231Chip> UnixRTC3231;
+typedef UnixRTCDevice<DS3232Chip> UnixRTC3232;
+typedef UnixRTCDevice<DS1307Chip> UnixRTC1307;
+
+#endif
@@ -0,0 +1,149 @@
+#include "UnixRTCDiscipline.h"
+
+#define MIN_TEMP_SPREAD 4.0f  //Temperature spread (x4 deg C, standard deviation) below which no temperature slope is fitted
+
+UnixRTCDiscipline::UnixRTCDiscipline(UnixRTC& rtc)
+  : rtc(rtc), count(0), next(0), observed(false), lastReference(0), lastOffset(0), lastTemp(25 * 4), aging(0), fitted(false), drift(0), slope(0), meanTemp(0), variance(-1), sumWeights(0), sumSquares(0) {}
+
+bool UnixRTCDiscipline::begin() {
+  uint8_t age;
+  if (!rtc.readRegisters(0x10, &age, 1)) return false;
+  aging = age;
+  return true;
+}
+
+void UnixRTCDiscipline::observe(uint64_t referenceMs, uint64_t rtcMs, int16_t temp) {
+  int32_t offsetMs = (int64_t)(rtcMs - referenceMs);
+  if (observed && referenceMs > lastReference) {
+    uint64_t elapsed = referenceMs - lastReference;
+    Interval interval;
+    interval.seconds = (elapsed + 500) / 1000;
+    interval.gained = (offsetMs - lastOffset) * 1000L + lround(aging * UNIXRTC_AGING_PPM * elapsed / 1000.0f);  //ppm x ms = ns, adds back what the offset held back
+    interval.temp = (temp + lastTemp) / 2;
+    if (interval.seconds) {
+      intervals[next] = interval;
+      next = (next + 1) % UNIXRTC_DISCIPLINE_SAMPLES;
+      if (count < UNIXRTC_DISCIPLINE_SAMPLES) count++;
+    }
+  }
+  observed = true;
+  lastReference = referenceMs;
+  lastOffset = offsetMs;
+  lastTemp = temp;
+  fit();
+}
+
+void UnixRTCDiscipline::stepped(int32_t ms) {
+  lastOffset += ms;
+}
+
+bool UnixRTCDiscipline::apply() {
+  int8_t age = recommendedOffset();
+  if (age == aging) return true;
+  if (!rtc.writeRegisters(0x10, (const uint8_t*)&age, 1)) return false;
+  aging = age;
+  rtc.startTempConversion();  //The new offset only reaches the oscillator with a conversion
+  return true;
+}
+
+void UnixRTCDiscipline::reset() {
+  count = 0;
+  next = 0;
+  observed = false;
+  fit();
+}
+
+uint8_t UnixRTCDiscipline::samples() {
+  return count;
+}
+
+int32_t UnixRTCDiscipline::offset() {
+  return lastOffset;
+}
+
+int8_t UnixRTCDiscipline::agingOffset() {
+  return aging;
+}
+
+int8_t UnixRTCDiscipline::recommendedOffset() {
+  if (!fitted) return aging;
+  float age = round(drift / UNIXRTC_AGING_PPM);  //At the mean temperature, so a noisy slope can't push the offset around
+  return age > 127 ? 127 : (age < -128 ? -128 : (int8_t)age);
+}
+
+float UnixRTCDiscipline::driftPPM() {
+  return fitted ? driftAt(lastTemp) : 0;
+}
+
+float UnixRTCDiscipline::residualPPM() {
+  return fitted ? driftAt(lastTemp) - aging * UNIXRTC_AGING_PPM : 0;
+}
+
+float UnixRTCDiscipline::uncertaintyPPM() {
+  return errorAt(lastTemp);
+}
+
+uint32_t UnixRTCDiscipline::predictedError(uint32_t seconds) {
+  float ppm = fabs(residualPPM()) + uncertaintyPPM();
+  float ms = ppm * seconds / 1000.0f;  //ppm x s = us
+  return ms >= 4294967295.0f ? 0xFFFFFFFF : (uint32_t)ms;
+}
+
+uint32_t UnixRTCDiscipline::nextResync(uint32_t toleranceMs) {
+  float ppm = fabs(residualPPM()) + uncertaintyPPM();
+  float seconds = toleranceMs * 1000.0f / ppm;
+  return seconds >= 4294967295.0f ? 0xFFFFFFFF : (uint32_t)seconds;
+}
+
+void UnixRTCDiscipline::fit() {  //Weighted least squares of drift (ppm) = drift + slope * (temp - meanTemp)
+  fitted = false;
+  variance = -1;
+  slope = 0;
+  if (!count) return;
+  float sumW = 0;
+  float sumT = 0;
+  float sumR = 0;
+  for (uint8_t i = 0; i < count; i++) {
+    float w = (float)intervals[i].seconds * intervals[i].seconds;
+    sumW += w;
+    sumT += w * intervals[i].temp;
+    sumR += w * intervals[i].gained / intervals[i].seconds;  //us per s is ppm
+  }
+  meanTemp = sumT / sumW;
+  drift = sumR / sumW;
+  float sxx = 0;
+  float sxy = 0;
+  for (uint8_t i = 0; i < count; i++) {
+    float w = (float)intervals[i].seconds * intervals[i].seconds;
+    float dt = intervals[i].temp - meanTemp;
+    sxx += w * dt * dt;
+    sxy += w * dt * ((float)intervals[i].gained / intervals[i].seconds - drift);
+  }
+  uint8_t parameters = 1;
+  if (count >= 3 && sxx > MIN_TEMP_SPREAD * MIN_TEMP_SPREAD * sumW) {
+    slope = sxy / sxx;
+    parameters = 2;
+  }
+  sumWeights = sumW;
+  sumSquares = sxx;
+  fitted = true;
+  if (count <= parameters) return;
+  float sumE = 0;
+  for (uint8_t i = 0; i < count; i++) {
+    float w = (float)intervals[i].seconds * intervals[i].seconds;
+    float e = (float)intervals[i].gained / intervals[i].seconds - driftAt(intervals[i].temp);
+    sumE += w * e * e;
+  }
+  variance = sumE / (count - parameters);
+}
+
+float UnixRTCDiscipline::driftAt(float temp) {
+  return drift + slope * (temp - meanTemp);
+}
+
+float UnixRTCDiscipline::errorAt(float temp) {  //Standard error of driftAt(temp)
+  if (variance < 0) return UNIXRTC_DRIFT_SPEC_PPM;
+  float v = variance / sumWeights;
+  if (slope != 0) v += variance * (temp - meanTemp) * (temp - meanTemp) / sumSquares;
+  return sqrt(v);
+}
@@ -0,0 +1,67 @@
+/*
+  UnixRTCDiscipline, closed-loop aging offset trimming from reference time observations
+  - Part of the UnixRTC library: https://github.com/cornflowerenderman/UnixRTClib (MIT License, see UnixRTC.h)
+
+  Each observe() compares the RTC against a reference (NTP, GPS, an upstream server...) and stores the time
+  gained since the previous observation, with the aging offset's effect taken out, in a small ring of
+  intervals. A weighted least-squares fit of drift against temperature over the ring estimates the crystal's
+  own error, apply() sets the aging offset that cancels it, and the fit's residuals give the uncertainty
+  behind predictedError() and nextResync(). Intervals are weighted by their length squared, as reading
+  errors shrink in proportion to the interval. Resyncing the RTC between observations is fine as long as
+  the step is reported with stepped().
+*/
+
+#ifndef UnixRTCDiscipline_h
+#define UnixRTCDiscipline_h
+
+#include "UnixRTC.h"
+
+#define UNIXRTC_DISCIPLINE_SAMPLES 16  //Intervals kept for the fit
+#define UNIXRTC_AGING_PPM 0.1f         //Frequency change per aging offset LSB (typical at 25 deg C, positive offsets slow the clock)
+#define UNIXRTC_DRIFT_SPEC_PPM 2.0f    //Drift assumed before there is a fit (DS3231 accuracy from 0 to 40 deg C)
+
+class UnixRTCDiscipline {  //Aging offset discipline for one RTC
+public:
+  UnixRTCDiscipline(UnixRTC& rtc);
+  bool begin();                                                   //Reads the aging offset in effect, false if the RTC couldn't be read
+  void observe(uint64_t referenceMs, uint64_t rtcMs, int16_t temp);  //Reference and RTC unix time in ms taken at the same moment, with the RTC temperature (in x4 deg C)
+  void stepped(int32_t ms);                                       //The RTC was moved by ms since the last observe() (-offset() after setting it to the reference)
+  bool apply();                                                   //Writes recommendedOffset() if it differs, call right after observe(), false if the write failed
+  void reset();                                                   //Forgets every interval (e.g. after a crystal or module change)
+  uint8_t samples();                                              //Intervals in the fit
+  int32_t offset();                                               //RTC minus reference in ms at the last observe(), after stepped()
+  int8_t agingOffset();                                           //Aging offset in effect
+  int8_t recommendedOffset();                                     //Aging offset cancelling the estimated drift
+  float driftPPM();                                               //Estimated crystal drift at an aging offset of 0 and the last temperature (positive runs fast)
+  float residualPPM();                                            //Estimated drift with the aging offset in effect, at the last temperature
+  float uncertaintyPPM();                                         //Standard error of the estimate, UNIXRTC_DRIFT_SPEC_PPM until two intervals are known
+  uint32_t predictedError(uint32_t seconds);                      //Likely error in ms after running free for seconds, with the aging offset in effect
+  uint32_t nextResync(uint32_t toleranceMs);                      //Seconds the RTC can run free before predictedError() reaches toleranceMs
+private:
+  struct Interval {
+    uint32_t seconds;  //Length
+    int32_t gained;    //Microseconds the RTC gained, without the aging offset's effect
+    int16_t temp;      //Mean temperature (in x4 deg C)
+  };
+  UnixRTC& rtc;
+  Interval intervals[UNIXRTC_DISCIPLINE_SAMPLES];
+  uint8_t count;
+  uint8_t next;        //Ring position of the next interval
+  bool observed;       //lastReference holds an observation
+  uint64_t lastReference;
+  int32_t lastOffset;
+  int16_t lastTemp;
+  int8_t aging;
+  bool fitted;         //Fit parameters below are valid
+  float drift;         //Drift at meanTemp (ppm)
+  float slope;         //Drift change per x4 deg C (ppm), 0 if the temperatures were too close to tell
+  float meanTemp;
+  float variance;      //Residual variance, negative if unknown
+  float sumWeights;
+  float sumSquares;    //Temperature spread about meanTemp
+  void fit();
+  float driftAt(float temp);
+  float errorAt(float temp);
+};
+
+#endif
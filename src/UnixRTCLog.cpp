@@ -0,0 +1,225 @@
+#include "UnixRTCLog.h"
+
+#define RECORDS_START 8          //Records follow the sequence, base time and bytes used
+#define RECORDS_END 30           //CRC in the last two bytes
+#define MAX_DELTA 2097152UL      //Seconds from the base time that fit in three 7 bit bytes (about 24 days)
+
+UnixRTCLog::UnixRTCLog(UnixRTC& rtc, uint8_t address, uint16_t firstPage, uint16_t pages)
+  : rtc(rtc), address(address), firstPage(firstPage), pages(pages), head(pages - 1), tail(0), count(0), sequence(0xFFFF), base(0), dirty(false), writing(false), writeMillis(0), pointer(0xFFFF), readIndex(0), readPosition(RECORDS_START) {
+  memset(page, 0, sizeof(page));
+  memset(readBuffer, 0, sizeof(readBuffer));
+}
+
+bool UnixRTCLog::begin() {  //Reads every page in one sequential pass, the newest valid page is the head and the oldest the tail
+  writing = true;  //A write from before a reset may still be running, this also checks the EEPROM is there
+  writeMillis = millis();
+  if (!waitReady()) return false;
+  bool found = false;
+  uint16_t newest = 0;
+  uint16_t oldest = 0;
+  uint16_t newestSequence = 0;
+  uint16_t oldestSequence = 0;
+  for (uint16_t i = 0; i < pages; i++) {
+    if (!readPage(i, readBuffer)) return false;
+    if (!valid(readBuffer)) continue;
+    uint16_t s = readBuffer[0] | (readBuffer[1] << 8);
+    if (!found || (int16_t)(s - newestSequence) > 0) {  //Compared across the wrap, the ring is far shorter than half the sequence range
+      newest = i;
+      newestSequence = s;
+    }
+    if (!found || (int16_t)(s - oldestSequence) < 0) {
+      oldest = i;
+      oldestSequence = s;
+    }
+    found = true;
+  }
+  dirty = false;
+  beginRead();
+  if (!found) {
+    head = pages - 1;
+    tail = 0;
+    count = 0;
+    sequence = 0xFFFF;
+    return true;
+  }
+  head = newest;
+  tail = oldest;
+  count = (head + pages - tail) % pages + 1;
+  sequence = newestSequence;
+  if (!readPage(head, page)) return false;  //Carries on filling the newest page
+  base = 0;
+  for (uint8_t i = 0; i < 5; i++) base |= (uint64_t)page[2 + i] << (8 * i);
+  return true;
+}
+
+bool UnixRTCLog::log(uint8_t event, const uint8_t* data, uint8_t length) {
+  return log(rtc.getTime(), event, data, length);
+}
+
+bool UnixRTCLog::log(uint64_t unix, uint8_t event, const uint8_t* data, uint8_t length) {
+  if (length > UNIXRTC_LOG_DATA || (length && !data)) return false;
+  bool fits = count && unix >= base && unix - base < MAX_DELTA;  //Time going backwards also starts a new page
+  uint32_t delta = fits ? unix - base : 0;
+  uint8_t size = (delta < 0x80 ? 1 : (delta < 0x4000 ? 2 : 3)) + 2 + length;
+  if (fits && RECORDS_START + page[7] + size > RECORDS_END) fits = false;
+  if (!fits) {
+    if (dirty && !commit()) return false;
+    head = (head + 1) % pages;
+    if (count < pages) {
+      count++;
+    } else {
+      tail = (tail + 1) % pages;  //Full, the oldest page is overwritten
+    }
+    if (++sequence == 0xFFFF) sequence = 0;  //Erased EEPROM reads 0xFFFF
+    base = unix;
+    delta = 0;
+    page[0] = sequence;
+    page[1] = sequence >> 8;
+    for (uint8_t i = 0; i < 5; i++) page[2 + i] = base >> (8 * i);
+    page[7] = 0;
+  }
+  uint8_t* p = page + RECORDS_START + page[7];
+  while (delta >= 0x80) {  //Low 7 bits first, the top bit marks another byte
+    *p++ = delta | 0x80;
+    delta >>= 7;
+  }
+  *p++ = delta;
+  *p++ = event;
+  *p++ = length;
+  if (length) memcpy(p, data, length);
+  page[7] = p + length - page - RECORDS_START;
+  dirty = true;
+  if (RECORDS_START + page[7] + 3 > RECORDS_END) return commit();  //No room for another record, written now rather than on the next one
+  return true;
+}
+
+bool UnixRTCLog::flush() {
+  return !dirty || commit();
+}
+
+bool UnixRTCLog::clear() {  //Invalidates the pages oldest first, so an interrupted clear still leaves a consistent log
+  static const uint8_t erased[2] = { 0xFF, 0xFF };
+  while (count) {
+    if (!writePage(tail, 0, erased, 2)) return false;
+    tail = (tail + 1) % pages;
+    count--;
+  }
+  tail = (head + 1) % pages;
+  dirty = false;
+  beginRead();
+  return true;
+}
+
+uint16_t UnixRTCLog::pagesUsed() {
+  return count;
+}
+
+void UnixRTCLog::beginRead() {
+  readIndex = 0;
+  readPosition = RECORDS_START;
+  readBuffer[7] = 0;
+}
+
+bool UnixRTCLog::readNext(UnixRTCLogRecord& record) {
+  while (true) {
+    uint8_t end = RECORDS_START + readBuffer[7];
+    if (readPosition < end) {
+      uint8_t i = readPosition;
+      uint32_t delta = 0;
+      readPosition = end;  //Skips the rest of the page unless the record is well formed
+      for (uint8_t shift = 0;; shift += 7) {
+        if (i >= end || shift > 14) break;
+        uint8_t b = readBuffer[i++];
+        delta |= (uint32_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) break;
+      }
+      if (i + 2 > end || readBuffer[i + 1] > UNIXRTC_LOG_DATA || i + 2 + readBuffer[i + 1] > end) continue;
+      uint64_t pageBase = 0;
+      for (uint8_t b = 0; b < 5; b++) pageBase |= (uint64_t)readBuffer[2 + b] << (8 * b);
+      record.time = pageBase + delta;
+      record.event = readBuffer[i];
+      record.length = readBuffer[i + 1];
+      memcpy(record.data, readBuffer + i + 2, record.length);
+      readPosition = i + 2 + record.length;
+      return true;
+    }
+    if (readIndex >= count) return false;
+    uint16_t index = (tail + readIndex) % pages;
+    readIndex++;
+    readPosition = RECORDS_START;
+    if (index == head) {
+      memcpy(readBuffer, page, UNIXRTC_LOG_PAGE);  //May hold records that aren't written yet
+    } else if (!readPage(index, readBuffer) || !valid(readBuffer)) {
+      readBuffer[7] = 0;
+    }
+  }
+}
+
+bool UnixRTCLog::waitReady() {  //The EEPROM ignores its address until the write cycle ends (ACK polling)
+  if (!writing) return true;
+  while (true) {
+    if (rtc.busTransfer(rtc.bus, address, nullptr, 0, nullptr, 0, false) == RTC_OK) {
+      writing = false;
+      return true;
+    }
+    if (millis() - writeMillis > UNIXRTC_LOG_WRITE_MS) return false;
+  }
+}
+
+bool UnixRTCLog::readPage(uint16_t index, uint8_t* data) {
+  if (!waitReady()) return false;
+  uint16_t at = (firstPage + index) * UNIXRTC_LOG_PAGE;
+  uint8_t head[2] = { (uint8_t)(at >> 8), (uint8_t)at };
+  uint8_t headLength = pointer == at ? 0 : 2;  //Consecutive pages are read on from the address counter without resending the address
+  pointer = 0xFFFF;
+  for (uint8_t got = 0; got < UNIXRTC_LOG_PAGE;) {
+    uint8_t chunk = UNIXRTC_LOG_PAGE - got < UNIXRTC_WIRE_BUFFER ? UNIXRTC_LOG_PAGE - got : UNIXRTC_WIRE_BUFFER;
+    if (rtc.busTransfer(rtc.bus, address, head, headLength, data + got, chunk, true) != RTC_OK) return false;
+    headLength = 0;
+    got += chunk;
+  }
+  pointer = at + UNIXRTC_LOG_PAGE;
+  return true;
+}
+
+bool UnixRTCLog::writePage(uint16_t index, uint8_t offset, const uint8_t* data, uint8_t length) {
+  uint16_t at = (firstPage + index) * UNIXRTC_LOG_PAGE + offset;
+  while (length) {
+    uint8_t chunk = length < UNIXRTC_WIRE_BUFFER - 2 ? length : UNIXRTC_WIRE_BUFFER - 2;  //Two bytes of the buffer hold the memory address
+    if (!waitReady()) return false;
+    uint8_t head[2] = { (uint8_t)(at >> 8), (uint8_t)at };
+    uint8_t error = rtc.busTransfer(rtc.bus, address, head, 2, (uint8_t*)data, chunk, false);
+    pointer = 0xFFFF;
+    writing = true;
+    writeMillis = millis();
+    if (error) return false;
+    at += chunk;
+    data += chunk;
+    length -= chunk;
+  }
+  return true;
+}
+
+bool UnixRTCLog::commit() {  //The CRC goes in the last write, so a page torn between two writes fails its check
+  uint16_t c = crc(page, RECORDS_END);
+  page[RECORDS_END] = c;
+  page[RECORDS_END + 1] = c >> 8;
+  if (!writePage(head, 0, page, UNIXRTC_LOG_PAGE)) return false;
+  dirty = false;
+  return true;
+}
+
+bool UnixRTCLog::valid(const uint8_t* data) {
+  if ((data[0] & data[1]) == 0xFF || data[7] > RECORDS_END - RECORDS_START) return false;
+  uint16_t c = crc(data, RECORDS_END);
+  return data[RECORDS_END] == (uint8_t)c && data[RECORDS_END + 1] == (uint8_t)(c >> 8);
+}
+
+uint16_t UnixRTCLog::crc(const uint8_t* data, uint8_t length) {
+  uint16_t c = 0xFFFF;
+  while (length--) {
+    c ^= (uint16_t)*data++ << 8;
+    for (uint8_t i = 0; i < 8; i++) c = c & 0x8000 ? (c << 1) ^ 0x1021 : c << 1;
+  }
+  return c;
+}
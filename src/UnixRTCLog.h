@@ -0,0 +1,70 @@
+/*
+  UnixRTCLog, a timestamped event log in the AT24C32 EEPROM found on most DS3231 modules
+  - Part of the UnixRTC library: https://github.com/cornflowerenderman/UnixRTClib (MIT License, see UnixRTC.h)
+
+  The EEPROM is used as a ring of 32 byte pages. Each page holds a sequence number, a base unix time and
+  records stamped with their offset from it (1-3 bytes), and ends with a CRC-16. Records are collected in
+  RAM and a page is written once when it fills up (or on flush()), so the EEPROM sees one write per page
+  instead of one per record, and as the ring always moves on to the next page, wear is spread evenly.
+  begin() finds the newest and oldest pages from the sequence numbers, so logging continues where it
+  stopped after a power loss. A page torn by a power loss fails its CRC and is skipped (after a flush(), the
+  page is written again as it fills, so a power loss during that write loses the records flushed before).
+
+  Page layout: sequence (2 bytes), base time (5 bytes), bytes used (1), records (22), CRC-16 (2)
+  Record layout: seconds since the base time (7 bits per byte), event, length, data
+*/
+
+#ifndef UnixRTCLog_h
+#define UnixRTCLog_h
+
+#include "UnixRTC.h"
+
+#define UNIXRTC_LOG_PAGE 32      //EEPROM page size
+#define UNIXRTC_LOG_DATA 17      //Most data bytes per record
+#define UNIXRTC_LOG_WRITE_MS 10  //Longest EEPROM write cycle (5ms on current parts, 10ms on older ones)
+
+struct UnixRTCLogRecord {  //One record, as returned by readNext()
+  uint64_t time;           //Unix time
+  uint8_t event;           //Event code, free for the sketch to use
+  uint8_t length;          //Number of data bytes
+  uint8_t data[UNIXRTC_LOG_DATA];
+};
+
+class UnixRTCLog {  //Ring log in an I2C EEPROM with 32 byte pages
+public:
+  UnixRTCLog(UnixRTC& rtc, uint8_t address = 0x57, uint16_t firstPage = 0, uint16_t pages = 128);  //EEPROM on the same bus as rtc, uses pages firstPage to firstPage + pages - 1 (128 pages is the whole AT24C32)
+  bool begin();                                                                       //Finds the newest page to continue from, false if the EEPROM doesn't respond
+  bool log(uint8_t event, const uint8_t* data = nullptr, uint8_t length = 0);         //Adds a record stamped with the RTC time, false if too long or the EEPROM failed
+  bool log(uint64_t unix, uint8_t event, const uint8_t* data = nullptr, uint8_t length = 0);  //Same with a given time
+  bool flush();                                                                       //Writes the page being filled now, instead of when it is full
+  bool clear();                                                                       //Erases the log
+  uint16_t pagesUsed();                                                               //Pages holding records, including the one being filled
+  void beginRead();                                                                   //Starts reading from the oldest record
+  bool readNext(UnixRTCLogRecord& record);                                            //Next record (including ones not yet written), false after the newest
+private:
+  UnixRTC& rtc;
+  uint8_t address;
+  uint16_t firstPage;
+  uint16_t pages;
+  uint8_t page[UNIXRTC_LOG_PAGE];  //Page being filled
+  uint16_t head;                   //Page being filled (or last written), relative to firstPage
+  uint16_t tail;                   //Oldest page
+  uint16_t count;                  //Pages from tail to head, 0 when empty
+  uint16_t sequence;               //Sequence number of the head page
+  uint64_t base;                   //Base time of the head page
+  bool dirty;                      //Head page has records that aren't written
+  bool writing;                    //A write cycle may be running
+  uint32_t writeMillis;            //millis() when it started
+  uint16_t pointer;                //EEPROM address counter, 0xFFFF if unknown
+  uint8_t readBuffer[UNIXRTC_LOG_PAGE];
+  uint16_t readIndex;              //Pages read since beginRead()
+  uint8_t readPosition;            //Next record in readBuffer
+  bool waitReady();                                                    //Polls for the end of a write cycle
+  bool readPage(uint16_t index, uint8_t* data);                        //Reads a page, sequentially if the address counter is already there
+  bool writePage(uint16_t index, uint8_t offset, const uint8_t* data, uint8_t length);  //Writes part of a page
+  bool commit();                                                       //Writes the head page with its CRC
+  static bool valid(const uint8_t* data);                              //Checks the CRC and layout of a page
+  static uint16_t crc(const uint8_t* data, uint8_t length);            //CRC-16/CCITT
+};
+
+#endif
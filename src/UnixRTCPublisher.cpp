@@ -0,0 +1,74 @@
+#include "UnixRTCPublisher.h"
+
+UnixRTCPublisher::UnixRTCPublisher(UnixRTC& rtc)
+  : rtc(rtc), sequence(0) {
+  memset(copies, 0, sizeof(copies));
+  memset(&latest, 0, sizeof(latest));
+}
+
+bool UnixRTCPublisher::refresh() {
+  UnixRTCSnapshot snapshot;
+  if (rtc.readSnapshot(snapshot)) {
+    publish(snapshot);
+    return true;
+  }
+  latest.error = snapshot.error;
+  write();
+  return false;
+}
+
+void UnixRTCPublisher::publish(const UnixRTCSnapshot& snapshot) {
+  latest.error = snapshot.error;
+  if (snapshot.error == RTC_OK) {
+    latest.micros = micros();
+    latest.time = snapshot.time;
+    latest.temp = snapshot.temp;
+    latest.control = snapshot.regs[0x0E];
+    latest.status = snapshot.regs[0x0F];
+    latest.agingOffset = snapshot.agingOffset;
+  }
+  write();
+}
+
+void UnixRTCPublisher::write() {  //Each copy is only written while the sequence steers readers to the other one
+  UnixRTCSequence s = sequence;
+  __atomic_store_n(&sequence, (UnixRTCSequence)(s + 1), __ATOMIC_RELEASE);  //The last call's copies[1] complete before readers are sent to it
+  __atomic_thread_fence(__ATOMIC_RELEASE);                                  //Sequence change visible before the copy changes
+  copies[0] = latest;
+  __atomic_thread_fence(__ATOMIC_RELEASE);  //Copy complete before readers are sent back to it
+  __atomic_store_n(&sequence, (UnixRTCSequence)(s + 2), __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  copies[1] = latest;
+}
+
+void UnixRTCPublisher::read(UnixRTCState& state) const {
+  UnixRTCSequence s;
+  do {
+    s = __atomic_load_n(&sequence, __ATOMIC_ACQUIRE);
+    state = copies[s & 1];
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);  //Copy read before the sequence is checked again
+  } while (__atomic_load_n(&sequence, __ATOMIC_RELAXED) != s);
+}
+
+uint64_t UnixRTCPublisher::getTime() const {
+  UnixRTCState state;
+  read(state);
+  if (!state.time) return 0;
+  return state.time + (micros() - state.micros) / 1000000UL;  //The refresh saw some point within its second, so this is as close as the refresh was
+}
+
+bool UnixRTCPublisher::timeValid() const {
+  UnixRTCState state;
+  read(state);
+  return state.time && !(state.status & 0x80);
+}
+
+int16_t UnixRTCPublisher::getTempInt() const {
+  UnixRTCState state;
+  read(state);
+  return state.temp;
+}
+
+UnixRTCSequence UnixRTCPublisher::generation() const {
+  return __atomic_load_n(&sequence, __ATOMIC_ACQUIRE);
+}
@@ -0,0 +1,51 @@
+/*
+  UnixRTCPublisher, the latest RTC state shared with any number of tasks and ISRs without locks
+  - Part of the UnixRTC library: https://github.com/cornflowerenderman/UnixRTClib (MIT License, see UnixRTC.h)
+
+  One owner task calls refresh() (or publish() from a UnixRTCAsync callback), which is the only code touching
+  the bus. Readers copy the published state through a seqlock and never block or use I2C, so they need no mutex
+  around Wire. The state is kept twice (a latched seqlock): the writer updates one copy while readers use the
+  other, so a reader that interrupts the writer, e.g. an ISR on the same core, still finds a stable copy instead
+  of spinning. A reader only retries if two whole publishes happen during its copy.
+*/
+
+#ifndef UnixRTCPublisher_h
+#define UnixRTCPublisher_h
+
+#include "UnixRTC.h"
+
+#ifdef __AVR__
+typedef uint8_t UnixRTCSequence;  //Single byte loads and stores are the only atomic ones on AVR
+#else
+typedef uint32_t UnixRTCSequence;
+#endif
+
+struct UnixRTCState {  //What readers see
+  uint64_t time;       //Unix time read by the last good refresh, 0 before the first one
+  uint32_t micros;     //micros() when it was read
+  int16_t temp;        //Temperature (in x4 deg C)
+  uint8_t control;     //Control register (0x0E)
+  uint8_t status;      //Status register (0x0F): OSF, EN32kHz, BSY, A2F, A1F
+  int8_t agingOffset;  //Crystal aging offset
+  uint8_t error;       //RTC_OK, or the RTC_ERR_* of the last refresh (the other fields then keep their last good values)
+};
+
+class UnixRTCPublisher {  //Single writer, many readers
+public:
+  UnixRTCPublisher(UnixRTC& rtc);
+  bool refresh();                                 //Owner only: reads every register in one burst and publishes them, false if the read failed
+  void publish(const UnixRTCSnapshot& snapshot);  //Owner only: publishes a snapshot read elsewhere (e.g. a RTC_READ_ALL from UnixRTCAsync)
+  void read(UnixRTCState& state) const;           //Any task or ISR: copies the latest state
+  uint64_t getTime() const;                       //Any task or ISR: published time moved on by the micros() since it was read, 0 before the first refresh
+  bool timeValid() const;                         //Any task or ISR: oscillator stop flag clear at the last refresh
+  int16_t getTempInt() const;                     //Any task or ISR: temperature (in x4 deg C)
+  UnixRTCSequence generation() const;             //Any task or ISR: changes with every publish
+private:
+  UnixRTC& rtc;
+  UnixRTCSequence sequence;  //Even: readers use copies[0], odd: copies[1]
+  UnixRTCState copies[2];
+  UnixRTCState latest;       //Owner's copy, the source of both
+  void write();              //Publishes latest
+};
+
+#endif
@@ -0,0 +1,133 @@
+#include "UnixRTCScheduler.h"
+
+#define MAX_ARM_AHEAD 2332800ULL  //27 days, any alarm within this window can only match the intended day of the month
+
+UnixRTCScheduler::UnixRTCScheduler(UnixRTC& rtc)
+  : rtc(rtc), count(0), armed(0) {
+  for (uint8_t i = 0; i < UNIXRTC_SCHEDULER_EVENTS; i++) index[i] = 0xFF;
+}
+
+void UnixRTCScheduler::begin(bool useInterrupt) {
+  UNIXRTC_CALL("UnixRTCScheduler::begin");
+  if (useInterrupt) rtc.beginConfig().enableSQW(false).alarm1Interrupt(true).commit();
+  rtc.clearAlm1();
+  armed = 0;
+  if (count) arm(rtc.getTime());
+}
+
+int8_t UnixRTCScheduler::schedule(uint64_t unix, UnixRTCEventCallback callback, void* context, uint32_t period) {
+  UNIXRTC_CALL("UnixRTCScheduler::schedule");
+  if (count >= UNIXRTC_SCHEDULER_EVENTS || !callback) return -1;
+  uint8_t slot = 0;
+  while (index[slot] != 0xFF) slot++;
+  events[slot].deadline = unix;
+  events[slot].period = period;
+  events[slot].callback = callback;
+  events[slot].context = context;
+  place(count++, slot);
+  siftUp(index[slot]);
+  if (heap[0] == slot) arm(rtc.getTime());  //New earliest deadline
+  return slot;
+}
+
+int8_t UnixRTCScheduler::scheduleIn(uint32_t seconds, UnixRTCEventCallback callback, void* context, uint32_t period) {
+  uint8_t earlier = rtc.lastError();  //Cleared so only this read counts, put back if it succeeds
+  uint64_t now = rtc.getTime();
+  if (!now || rtc.lastError(false) != RTC_OK) return -1;  //Relative to a failed read the deadline would be in 1970 and run at once
+  rtc.error = earlier;
+  return schedule(now + seconds, callback, context, period);
+}
+
+bool UnixRTCScheduler::cancel(int8_t id) {
+  if (id < 0 || id >= UNIXRTC_SCHEDULER_EVENTS || index[id] == 0xFF) return false;
+  removeAt(index[id]);  //Alarm 1 is left as is, an early wake up just re-arms it
+  return true;
+}
+
+uint8_t UnixRTCScheduler::pending() {
+  return count;
+}
+
+uint64_t UnixRTCScheduler::nextDeadline() {
+  return count ? events[heap[0]].deadline : 0;
+}
+
+bool UnixRTCScheduler::service() {
+  UNIXRTC_CALL("UnixRTCScheduler::service");
+  rtc.invalidateIncrementalReads();  //Woken by the alarm, possibly from a sleep that stopped millis()
+  uint8_t regs[16];
+  if (!rtc.readRegisters(0x00, regs, 16)) return false;  //Time and status (0x00-0x0F) in one burst, INT stays low for the next try
+  uint8_t day;
+  uint8_t month;
+  uint8_t year;
+  uint64_t now = rtc.decodeTime(regs, day, month, year);
+  uint8_t status = regs[0x0F];
+  if (status & 0x01) rtc.writeStatus((status | 0x03) & 0xFE);  //Clears A1F, A2F is written as 1 so it can't be lost
+  bool ran = false;
+  while (count && events[heap[0]].deadline <= now) {
+    uint8_t slot = heap[0];
+    Event event = events[slot];  //Copied first, so the callback can cancel or schedule events
+    if (event.period) {
+      events[slot].deadline += ((now - event.deadline) / event.period + 1) * event.period;  //Skips missed periods
+      siftDown(0);
+    } else {
+      removeAt(0);
+    }
+    event.callback(event.deadline, event.context);
+    ran = true;
+  }
+  if (ran) {  //Callbacks may have taken a while
+    uint64_t after = rtc.getTime();
+    if (after) now = after;
+  }
+  arm(now);
+  return ran;
+}
+
+void UnixRTCScheduler::arm(uint64_t now) {  //Sets Alarm 1 to the earliest deadline (or an intermediate wake up), writing only if it changes
+  if (!count) return;
+  uint64_t target = events[heap[0]].deadline;
+  if (target < now + 2) target = now + 2;  //The current second may end before the write, never arm the one after it
+  if (target > now + MAX_ARM_AHEAD) target = now + MAX_ARM_AHEAD;
+  if (armed > now && armed <= target) return;  //Already due to wake up in time
+  armed = rtc.setAlarm1Time(target) ? target : 0;  //Unknown after a failed write, so the next call writes it again
+}
+
+void UnixRTCScheduler::place(uint8_t position, uint8_t slot) {
+  heap[position] = slot;
+  index[slot] = position;
+}
+
+void UnixRTCScheduler::siftUp(uint8_t position) {
+  uint8_t slot = heap[position];
+  while (position > 0) {
+    uint8_t parent = (position - 1) >> 1;
+    if (events[heap[parent]].deadline <= events[slot].deadline) break;
+    place(position, heap[parent]);
+    position = parent;
+  }
+  place(position, slot);
+}
+
+void UnixRTCScheduler::siftDown(uint8_t position) {
+  uint8_t slot = heap[position];
+  while (true) {
+    uint8_t child = position * 2 + 1;
+    if (child >= count) break;
+    if (child + 1 < count && events[heap[child + 1]].deadline < events[heap[child]].deadline) child++;
+    if (events[slot].deadline <= events[heap[child]].deadline) break;
+    place(position, heap[child]);
+    position = child;
+  }
+  place(position, slot);
+}
+
+void UnixRTCScheduler::removeAt(uint8_t position) {
+  index[heap[position]] = 0xFF;
+  count--;
+  if (position == count) return;
+  uint8_t moved = heap[count];  //Last leaf fills the gap, then moves whichever way restores the order
+  place(position, moved);
+  siftUp(position);
+  siftDown(index[moved]);
+}
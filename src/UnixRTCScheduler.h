@@ -0,0 +1,50 @@
+/*
+  UnixRTCScheduler, any number of timed events multiplexed onto the DS3231's Alarm 1
+  - Part of the UnixRTC library: https://github.com/cornflowerenderman/UnixRTClib (MIT License, see UnixRTC.h)
+
+  Pending events are kept in a fixed size min-heap ordered by deadline, and Alarm 1 is always armed with the
+  earliest one, so the INT pin wakes the MCU for the next event and nothing has to poll the bus in between.
+  Alarm 1 only matches the day of the month, so deadlines more than 27 days away are reached through
+  intermediate wake ups that run nothing and re-arm the alarm.
+*/
+
+#ifndef UnixRTCScheduler_h
+#define UnixRTCScheduler_h
+
+#include "UnixRTC.h"
+
+#define UNIXRTC_SCHEDULER_EVENTS 16  //Maximum number of pending events
+
+typedef void (*UnixRTCEventCallback)(uint64_t deadline, void* context);
+
+class UnixRTCScheduler {  //Event scheduler for one RTC, owns Alarm 1
+public:
+  UnixRTCScheduler(UnixRTC& rtc);
+  void begin(bool useInterrupt = true);                                                                             //Switches INT/SQW to INT mode with the Alarm 1 interrupt enabled (if useInterrupt), clears A1F
+  int8_t schedule(uint64_t unix, UnixRTCEventCallback callback, void* context = nullptr, uint32_t period = 0);        //Adds an event (repeating every period seconds if non-zero), returns its id or -1 if full
+  int8_t scheduleIn(uint32_t seconds, UnixRTCEventCallback callback, void* context = nullptr, uint32_t period = 0);   //Same as schedule(), relative to the current RTC time, -1 if it couldn't be read (see lastError())
+  bool cancel(int8_t id);                                                                                           //Removes a pending event, false if the id is not pending
+  uint8_t pending();                                                                                                //Number of pending events
+  uint64_t nextDeadline();                                                                                          //Deadline of the earliest event, 0 if none
+  bool service();                                                                                                   //Call when the INT pin fires: runs due events and re-arms Alarm 1, returns true if any ran
+private:
+  struct Event {
+    uint64_t deadline;
+    uint32_t period;
+    UnixRTCEventCallback callback;
+    void* context;
+  };
+  UnixRTC& rtc;
+  Event events[UNIXRTC_SCHEDULER_EVENTS];  //Slots, indexed by id
+  uint8_t heap[UNIXRTC_SCHEDULER_EVENTS];  //Slot ids ordered as a binary min-heap on deadline
+  uint8_t index[UNIXRTC_SCHEDULER_EVENTS];  //Heap position of each slot, 0xFF when free
+  uint8_t count;
+  uint64_t armed;  //Time Alarm 1 is set to, 0 if unknown
+  void arm(uint64_t now);
+  void place(uint8_t position, uint8_t slot);
+  void siftUp(uint8_t position);
+  void siftDown(uint8_t position);
+  void removeAt(uint8_t position);
+};
+
+#endif
@@ -0,0 +1,60 @@
+#include "UnixRTCTempHistory.h"
+
+UnixRTCTempHistory::UnixRTCTempHistory() {
+  reset();
+}
+
+void UnixRTCTempHistory::add(int16_t temp) {
+  ring[next] = temp;
+  next = (next + 1) % UNIXRTC_TEMP_HISTORY;
+  if (used < UNIXRTC_TEMP_HISTORY) used++;
+  if (!samples || temp < low) low = temp;
+  if (!samples || temp > high) high = temp;
+  samples++;
+  sum += temp;
+  sumSquares += (int32_t)temp * temp;
+}
+
+void UnixRTCTempHistory::reset() {
+  memset(ring, 0, sizeof(ring));
+  next = 0;
+  used = 0;
+  samples = 0;
+  low = 0;
+  high = 0;
+  sum = 0;
+  sumSquares = 0;
+}
+
+uint8_t UnixRTCTempHistory::size() {
+  return used;
+}
+
+int16_t UnixRTCTempHistory::get(uint8_t age) {
+  if (age >= used) return 0;
+  return ring[(next + UNIXRTC_TEMP_HISTORY - 1 - age) % UNIXRTC_TEMP_HISTORY];
+}
+
+uint32_t UnixRTCTempHistory::count() {
+  return samples;
+}
+
+int16_t UnixRTCTempHistory::lowest() {
+  return low;
+}
+
+int16_t UnixRTCTempHistory::highest() {
+  return high;
+}
+
+int16_t UnixRTCTempHistory::mean() {
+  if (!samples) return 0;
+  int64_t half = samples / 2;
+  return (sum + (sum < 0 ? -half : half)) / (int64_t)samples;  //Rounded away from zero at .5
+}
+
+uint32_t UnixRTCTempHistory::variance() {  //Exact in integers: (n * sum of squares - sum^2) / (n * (n - 1))
+  if (samples < 2) return 0;
+  int64_t n = samples;
+  return (n * sumSquares - sum * sum + n * (n - 1) / 2) / (n * (n - 1));
+}
@@ -0,0 +1,44 @@
+/*
+  UnixRTCTempHistory, temperature history from the DS3231's own conversions
+  - Part of the UnixRTC library: https://github.com/cornflowerenderman/UnixRTClib (MIT License, see UnixRTC.h)
+
+  The DS3231 converts every 64 seconds by itself, so a history never needs to force a conversion. Once attached
+  with UnixRTC::trackTemp(), a sample is taken at most every UNIXRTC_TEMP_PERIOD_MS: getTime() stretches its read
+  to include the temperature registers when one is due (one longer burst, no extra transaction), and snapshot
+  reads (readSnapshot(), UnixRTCAsync, UnixRTCPublisher) and temperature reads add theirs for free.
+  Samples go into a ring, and the count, lowest, highest, mean and variance since reset() are kept in integers,
+  in the same x4 deg C units as getTempInt().
+*/
+
+#ifndef UnixRTCTempHistory_h
+#define UnixRTCTempHistory_h
+
+#include "Arduino.h"  //Arduino core libraries
+
+#define UNIXRTC_TEMP_HISTORY 32       //Samples kept in the ring (about half an hour at one per conversion)
+#define UNIXRTC_TEMP_PERIOD_MS 64000  //Shortest millis() between samples, the DS3231's conversion period
+
+class UnixRTCTempHistory {  //Ring of samples with running statistics
+public:
+  UnixRTCTempHistory();
+  void add(int16_t temp);     //Adds a sample (in x4 deg C), called by UnixRTC
+  void reset();               //Clears the ring and the statistics
+  uint8_t size();             //Samples in the ring
+  int16_t get(uint8_t age);   //Sample from the ring, 0 being the newest
+  uint32_t count();           //Samples since reset()
+  int16_t lowest();           //Lowest sample (in x4 deg C), 0 if none
+  int16_t highest();          //Highest sample (in x4 deg C), 0 if none
+  int16_t mean();             //Mean (in x4 deg C, rounded), 0 if none
+  uint32_t variance();        //Sample variance (in 1/16 deg C squared), 0 with fewer than two samples
+private:
+  int16_t ring[UNIXRTC_TEMP_HISTORY];
+  uint8_t next;  //Ring position of the next sample
+  uint8_t used;
+  uint32_t samples;
+  int16_t low;
+  int16_t high;
+  int64_t sum;
+  int64_t sumSquares;
+};
+
+#endif
@@ -0,0 +1,203 @@
+#include "UnixRTCTimeZone.h"
+
+#define Y2000_UNIX 946684800ULL  //2000-01-01 00:00:00
+#define Y2200_UNIX 7258118400ULL  //2200-01-01 00:00:00
+
+UnixRTCTimeZone::UnixRTCTimeZone() {
+  begin("UTC0");
+}
+
+bool UnixRTCTimeZone::begin(const char* tz) {
+  if (parse(tz)) return true;
+  parse("UTC0");
+  return false;
+}
+
+uint64_t UnixRTCTimeZone::toLocal(uint64_t utc) {
+  if (utc - cacheStart >= cacheSpan) update(utc);  //Unsigned, so times before cacheStart also miss
+  return utc + cacheOffset;
+}
+
+uint64_t UnixRTCTimeZone::fromLocal(uint64_t local) {
+  uint64_t utc = local - stdOffset;
+  uint64_t adjusted = local - getOffset(utc);
+  return getOffset(adjusted) == getOffset(utc) ? adjusted : utc;
+}
+
+int32_t UnixRTCTimeZone::getOffset(uint64_t utc) {
+  if (utc - cacheStart >= cacheSpan) update(utc);
+  return cacheOffset;
+}
+
+bool UnixRTCTimeZone::isDST(uint64_t utc) {
+  if (utc - cacheStart >= cacheSpan) update(utc);
+  return cacheDST;
+}
+
+const char* UnixRTCTimeZone::getName(uint64_t utc) {
+  return isDST(utc) ? dstName : stdName;
+}
+
+uint64_t UnixRTCTimeZone::nextTransition(uint64_t utc) {
+  if (utc - cacheStart >= cacheSpan) update(utc);
+  uint64_t next = cacheStart + cacheSpan;
+  return next < cacheStart || next >= Y2200_UNIX ? 0 : next;
+}
+
+void UnixRTCTimeZone::update(uint64_t utc) {  //Finds the transitions either side of utc among those of the previous, current and next year
+  cacheOffset = stdOffset;
+  cacheDST = false;
+  cacheStart = 0;
+  cacheSpan = ~0ULL;
+  if (!hasDST) return;
+  uint64_t clamped = utc < Y2000_UNIX ? Y2000_UNIX : (utc >= Y2200_UNIX ? Y2200_UNIX - 1 : utc);
+  uint8_t second;
+  uint8_t minute;
+  uint8_t hour;
+  uint8_t dayOfWeek;
+  uint8_t day;
+  uint8_t month;
+  uint8_t year;
+  UnixRTC::dateFromUnix(clamped, second, minute, hour, dayOfWeek, day, month, year);
+  bool found = false;
+  uint64_t next = ~0ULL;
+  bool nextDST = false;
+  for (int16_t y = year - 1; y <= year + 1; y++) {
+    if (y < 0 || y > 199) continue;
+    uint64_t times[2] = { transition(start, y) - stdOffset, transition(end, y) - dstOffset };  //Rule times are local, before the change
+    for (uint8_t i = 0; i < 2; i++) {
+      if (times[i] <= utc) {
+        if (!found || times[i] >= cacheStart) {
+          cacheStart = times[i];
+          cacheDST = i == 0;
+          found = true;
+        }
+      } else if (times[i] < next) {
+        next = times[i];
+        nextDST = i == 0;
+      }
+    }
+  }
+  if (!found) cacheDST = !nextDST;  //Before the first known transition, the opposite of what it switches to
+  cacheOffset = cacheDST ? dstOffset : stdOffset;
+  cacheSpan = next - cacheStart;
+}
+
+uint64_t UnixRTCTimeZone::transition(const Rule& rule, uint8_t year) {
+  uint64_t yearStart = UnixRTC::unixFromDate(0, 0, 0, 1, 1, year);
+  if (rule.type == 'D') return yearStart + rule.day * 86400UL + rule.time;
+  if (rule.type == 'J') {
+    bool leap = UnixRTC::unixFromDate(0, 0, 0, 1, 3, year) - UnixRTC::unixFromDate(0, 0, 0, 1, 2, year) == 29 * 86400UL;
+    return yearStart + (rule.day - 1 + (leap && rule.day >= 60 ? 1 : 0)) * 86400UL + rule.time;
+  }
+  uint64_t monthStart = UnixRTC::unixFromDate(0, 0, 0, 1, rule.month, year);
+  uint8_t second;
+  uint8_t minute;
+  uint8_t hour;
+  uint8_t firstWeekday;
+  uint8_t day;
+  uint8_t month;
+  uint8_t y;
+  UnixRTC::dateFromUnix(monthStart, second, minute, hour, firstWeekday, day, month, y);
+  uint8_t date = 1 + (rule.weekday + 7 - firstWeekday) % 7 + (rule.week - 1) * 7;
+  if (rule.week == 5) {  //Last such weekday, which may be the fourth
+    uint64_t monthEnd = rule.month == 12 ? UnixRTC::unixFromDate(0, 0, 0, 1, 1, year + 1) : UnixRTC::unixFromDate(0, 0, 0, 1, rule.month + 1, year);
+    if (monthStart + date * 86400ULL > monthEnd) date -= 7;
+  }
+  return monthStart + (date - 1) * 86400UL + rule.time;
+}
+
+bool UnixRTCTimeZone::parse(const char* tz) {  //std offset [dst [offset] [,start[/time],end[/time]]]
+  int32_t offset;
+  cacheSpan = 0;
+  hasDST = false;
+  if (!parseName(tz, stdName) || !parseTime(tz, offset, 24)) return false;
+  stdOffset = -offset;  //POSIX offsets are west of UTC
+  dstOffset = stdOffset;
+  dstName[0] = 0;
+  if (!*tz) return true;
+  if (!parseName(tz, dstName)) return false;
+  dstOffset = stdOffset + 3600;  //Default, one hour ahead of standard time
+  if (*tz && *tz != ',') {
+    if (!parseTime(tz, offset, 24)) return false;
+    dstOffset = -offset;
+  }
+  if (*tz == ',') {
+    tz++;
+    if (!parseRule(tz, start) || *tz++ != ',' || !parseRule(tz, end)) return false;
+  } else {  //No rules, POSIX leaves this to the implementation, use the current US rules like glibc
+    const char* rules = "M3.2.0,M11.1.0";
+    parseRule(rules, start);
+    rules++;
+    parseRule(rules, end);
+  }
+  if (*tz) return false;
+  hasDST = true;
+  return true;
+}
+
+bool UnixRTCTimeZone::parseNumber(const char*& text, uint16_t& value, uint16_t max) {  //1-3 digits, at most max
+  uint8_t digits = 0;
+  value = 0;
+  while ((uint8_t)(*text - '0') <= 9 && digits < 3) {
+    value = value * 10 + (*text++ - '0');
+    digits++;
+  }
+  return digits && value <= max;
+}
+
+bool UnixRTCTimeZone::parseName(const char*& text, char* name) {  //Letters, or anything between < and > (e.g. "<+0530>")
+  uint8_t length = 0;
+  bool quoted = *text == '<';
+  if (quoted) text++;
+  while (quoted ? (*text && *text != '>') : ((*text | 0x20) >= 'a' && (*text | 0x20) <= 'z')) {
+    if (length < UNIXRTC_TZ_NAME) name[length] = *text;
+    length++;
+    text++;
+  }
+  if (quoted && *text++ != '>') return false;
+  name[length < UNIXRTC_TZ_NAME ? length : UNIXRTC_TZ_NAME] = 0;
+  return length >= 3;
+}
+
+bool UnixRTCTimeZone::parseTime(const char*& text, int32_t& seconds, uint8_t maxHours) {  //[+|-]hh[:mm[:ss]]
+  bool negative = *text == '-';
+  if (*text == '+' || *text == '-') text++;
+  uint16_t hours;
+  uint16_t minutes = 0;
+  uint16_t secs = 0;
+  if (!parseNumber(text, hours, maxHours)) return false;
+  if (*text == ':') {
+    text++;
+    if (!parseNumber(text, minutes, 59)) return false;
+    if (*text == ':') {
+      text++;
+      if (!parseNumber(text, secs, 59)) return false;
+    }
+  }
+  seconds = hours * 3600L + minutes * 60 + secs;
+  if (negative) seconds = -seconds;
+  return true;
+}
+
+bool UnixRTCTimeZone::parseRule(const char*& text, Rule& rule) {  //Jn, n or Mm.w.d, then an optional /time
+  rule.type = *text == 'J' || *text == 'M' ? *text++ : 'D';
+  if (rule.type == 'M') {
+    uint16_t month;
+    uint16_t week;
+    uint16_t weekday;
+    if (!parseNumber(text, month, 12) || *text++ != '.' || !parseNumber(text, week, 5) || *text++ != '.' || !parseNumber(text, weekday, 6)) return false;
+    if (!month || !week) return false;
+    rule.month = month;
+    rule.week = week;
+    rule.weekday = weekday;
+  } else {
+    if (!parseNumber(text, rule.day, 365) || (rule.type == 'J' && !rule.day)) return false;
+  }
+  rule.time = 7200;  //Default 02:00
+  if (*text == '/') {
+    text++;
+    if (!parseTime(text, rule.time, 167)) return false;
+  }
+  return true;
+}
@@ -0,0 +1,57 @@
+/*
+  UnixRTCTimeZone, local time from the UTC kept by UnixRTC using POSIX TZ rules
+  - Part of the UnixRTC library: https://github.com/cornflowerenderman/UnixRTClib (MIT License, see UnixRTC.h)
+
+  Rules are written as POSIX TZ strings, e.g. "CET-1CEST,M3.5.0,M10.5.0/3" or "AEST-10AEDT,M10.1.0,M4.1.0/3"
+  (the same strings as the TZ environment variable, see the tz database's zone1970.tab for every zone).
+  The offset in effect and the span until the next transition are cached, so until that transition passes
+  converting to local time is one compare and one add. Transitions are computed with UnixRTC's calendar code.
+*/
+
+#ifndef UnixRTCTimeZone_h
+#define UnixRTCTimeZone_h
+
+#include "UnixRTC.h"
+
+#define UNIXRTC_TZ_NAME 7  //Longest time zone abbreviation kept (longer ones are truncated)
+
+class UnixRTCTimeZone {  //One time zone
+public:
+  UnixRTCTimeZone();                            //Starts as UTC
+  bool begin(const char* tz);                   //Parses a POSIX TZ string, false (and UTC) if malformed
+  uint64_t toLocal(uint64_t utc);               //Local time from unix time
+  uint64_t fromLocal(uint64_t local);           //Unix time from local time, times skipped or repeated by a transition resolve as standard time
+  int32_t getOffset(uint64_t utc);              //Offset east of UTC in seconds, e.g. for formatISO8601(utc, buffer, size, getOffset(utc) / 60)
+  bool isDST(uint64_t utc);                     //True while daylight saving time is in effect
+  const char* getName(uint64_t utc);            //Abbreviation in effect, e.g. "CEST"
+  uint64_t nextTransition(uint64_t utc);        //Unix time of the next change of offset, 0 if none
+private:
+  struct Rule {
+    char type;      //'J' (day 1-365, no Feb 29), 'D' (day 0-365) or 'M' (month, week, weekday)
+    uint16_t day;   //Day of the year for 'J' and 'D'
+    uint8_t month;  //1-12
+    uint8_t week;   //1-5, 5 being the last
+    uint8_t weekday;  //0-6, 0 being Sunday
+    int32_t time;   //Local time of day of the transition in seconds (may be negative or beyond a day)
+  };
+  char stdName[UNIXRTC_TZ_NAME + 1];
+  char dstName[UNIXRTC_TZ_NAME + 1];
+  int32_t stdOffset;  //Seconds east of UTC
+  int32_t dstOffset;
+  bool hasDST;
+  Rule start;  //Daylight saving time starts (in standard time)
+  Rule end;    //Daylight saving time ends (in daylight saving time)
+  uint64_t cacheStart;   //Last transition at or before the cached span
+  uint64_t cacheSpan;    //Seconds from cacheStart to the next transition, 0 when nothing is cached
+  int32_t cacheOffset;
+  bool cacheDST;
+  void update(uint64_t utc);                            //Recomputes the cached span around utc
+  uint64_t transition(const Rule& rule, uint8_t year);  //Local time of a transition, as if it were unix time
+  bool parse(const char* tz);
+  static bool parseNumber(const char*& text, uint16_t& value, uint16_t max);
+  static bool parseName(const char*& text, char* name);
+  static bool parseTime(const char*& text, int32_t& seconds, uint8_t maxHours);
+  static bool parseRule(const char*& text, Rule& rule);
+};
+
+#endif
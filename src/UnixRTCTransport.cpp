@@ -0,0 +1,76 @@
+#include "UnixRTCTransport.h"
+
+#ifndef UNIXRTC_NO_WIRE
+UnixRTCWire::UnixRTCWire(TwoWire& wire)
+  : wire(&wire) {}
+
+void UnixRTCWire::begin() {
+  wire->begin();
+}
+
+void UnixRTCWire::end() {
+  wire->end();
+}
+
+void UnixRTCWire::setTimeout(uint32_t us) {
+#ifdef WIRE_HAS_TIMEOUT
+  wire->setWireTimeout(us ? us : 25000, true);  //A hung transfer resets the TWI hardware instead of blocking forever (25ms is the core's default)
+#else
+  (void)us;
+#endif
+}
+
+uint8_t UnixRTCWire::transfer(uint8_t address, const uint8_t* head, uint8_t headLength, uint8_t* data, uint8_t length, bool read) {
+  if (!read || headLength) {
+    wire->beginTransmission(address);
+    for (uint8_t i = 0; i < headLength; i++) wire->write(head[i]);
+    if (!read) {
+      for (uint8_t i = 0; i < length; i++) wire->write(data[i]);
+    }
+    uint8_t result = wire->endTransmission();
+    if (result) return result > RTC_ERR_TIMEOUT ? RTC_ERR_BUS : result;  //endTransmission() codes match RTC_ERR_* up to 5
+    if (!read) return RTC_OK;
+  }
+  if (wire->requestFrom(address, length) != length) {
+    while (wire->available()) wire->read();
+    return RTC_ERR_SHORT_READ;
+  }
+  for (uint8_t i = 0; i < length; i++) data[i] = wire->read();
+  return RTC_OK;
+}
+#endif
+
+UnixRTCMockBus::UnixRTCMockBus(uint8_t address)
+  : address(address), pointer(0), transfers(0), bytesWritten(0), bytesRead(0), failures(0), failError(RTC_OK) {
+  memset(regs, 0, sizeof(regs));
+}
+
+uint8_t UnixRTCMockBus::transfer(uint8_t address, const uint8_t* head, uint8_t headLength, uint8_t* data, uint8_t length, bool read) {
+  transfers++;
+  if (failures) {
+    failures--;
+    return failError;
+  }
+  if (address != this->address) return RTC_ERR_NACK_ADDRESS;
+  if (headLength) pointer = head[0];
+  for (uint8_t i = 1; i < headLength; i++) regs[pointer++] = head[i];
+  bytesWritten += headLength;
+  for (uint8_t i = 0; i < length; i++) {
+    if (read) {
+      data[i] = regs[pointer++];
+    } else {
+      regs[pointer++] = data[i];
+    }
+  }
+  if (read) {
+    bytesRead += length;
+  } else {
+    bytesWritten += length;
+  }
+  return RTC_OK;
+}
+
+void UnixRTCMockBus::fail(uint8_t count, uint8_t error) {
+  failures = count;
+  failError = error;
+}
@@ -0,0 +1,96 @@
+/*
+  UnixRTCTransport, the I2C bus a UnixRTC talks through
+  - Part of the UnixRTC library: https://github.com/cornflowerenderman/UnixRTClib (MIT License, see UnixRTC.h)
+
+  A transport is any class with these members, there is no base class to inherit from:
+    void begin();                  //Sets up the bus, called by UnixRTC::begin()
+    void end();                    //Releases the bus pins, called before bus recovery
+    void setTimeout(uint32_t us);  //Bounds a single transfer, 0 for the default
+    uint8_t transfer(uint8_t address, const uint8_t* head, uint8_t headLength, uint8_t* data, uint8_t length, bool read);
+      //Writes head (e.g. a register pointer), then reads length bytes into data if read, or else writes data in the
+      //same transaction. headLength 0 with read reads on from the device's own pointer, headLength and length 0
+      //only checks the address is acknowledged. Returns RTC_OK or a RTC_ERR_* code.
+  UnixRTC's constructor is a template over the transport type, which binds the transport's own transfer() to a
+  function pointer, so a transaction is one call through that pointer, no vtable and no virtual functions.
+  UnixRTCWire (any TwoWire, the default) and UnixRTCMockBus are here, a Linux /dev/i2c-N transport is in
+  extras/linux. Define UNIXRTC_NO_WIRE to build without the Arduino Wire library.
+*/
+
+#ifndef UnixRTCTransport_h
+#define UnixRTCTransport_h
+
+#include "Arduino.h"  //Arduino core libraries
+#ifndef UNIXRTC_NO_WIRE
+#include "Wire.h"  //Arduino builtin I2C library
+#endif
+
+#define RTC_OK 0               //No error
+#define RTC_ERR_TOO_LONG 1     //Transaction longer than the Wire buffer
+#define RTC_ERR_NACK_ADDRESS 2 //RTC didn't acknowledge its address (missing, or the bus is held)
+#define RTC_ERR_NACK_DATA 3    //RTC didn't acknowledge a byte
+#define RTC_ERR_BUS 4          //Other bus error (lost arbitration, SDA held low...)
+#define RTC_ERR_TIMEOUT 5      //Wire timeout, on cores with setWireTimeout()
+#define RTC_ERR_SHORT_READ 6   //Fewer bytes arrived than were requested
+#define RTC_ERR_IMPLAUSIBLE 7  //Time registers failed the BCD and range check
+
+typedef uint8_t (*UnixRTCTransferFunction)(void* bus, uint8_t address, const uint8_t* head, uint8_t headLength, uint8_t* data, uint8_t length, bool read);
+
+struct UnixRTCBusControl {  //Setup calls of a transport, off the transaction path
+  void (*begin)(void* bus);
+  void (*end)(void* bus);
+  void (*setTimeout)(void* bus, uint32_t us);
+};
+
+template <class Bus>
+struct UnixRTCBinding {  //Calls one transport type's members through the pointers UnixRTC keeps
+  static uint8_t transfer(void* bus, uint8_t address, const uint8_t* head, uint8_t headLength, uint8_t* data, uint8_t length, bool read) {
+    return static_cast<Bus*>(bus)->transfer(address, head, headLength, data, length, read);
+  }
+  static void begin(void* bus) {
+    static_cast<Bus*>(bus)->begin();
+  }
+  static void end(void* bus) {
+    static_cast<Bus*>(bus)->end();
+  }
+  static void setTimeout(void* bus, uint32_t us) {
+    static_cast<Bus*>(bus)->setTimeout(us);
+  }
+  static const UnixRTCBusControl control;
+};
+
+template <class Bus>
+const UnixRTCBusControl UnixRTCBinding<Bus>::control = { &UnixRTCBinding<Bus>::begin, &UnixRTCBinding<Bus>::end, &UnixRTCBinding<Bus>::setTimeout };
+
+#ifndef UNIXRTC_NO_WIRE
+class UnixRTCWire {  //Any TwoWire (Wire, Wire1...), the pointer write and the read are separate transactions as on every Arduino core
+public:
+  UnixRTCWire(TwoWire& wire = Wire);
+  void begin();
+  void end();
+  void setTimeout(uint32_t us);  //setWireTimeout() on cores that have it
+  uint8_t transfer(uint8_t address, const uint8_t* head, uint8_t headLength, uint8_t* data, uint8_t length, bool read);
+private:
+  TwoWire* wire;
+};
+#endif
+
+class UnixRTCMockBus {  //In memory device for tests: 256 registers behind one address, with an auto-incrementing pointer
+public:
+  UnixRTCMockBus(uint8_t address = 0x68);
+  void begin() {}
+  void end() {}
+  void setTimeout(uint32_t) {}
+  uint8_t transfer(uint8_t address, const uint8_t* head, uint8_t headLength, uint8_t* data, uint8_t length, bool read);
+  void fail(uint8_t count, uint8_t error = RTC_ERR_NACK_ADDRESS);  //The next count transfers return error
+  uint8_t address;     //Only this address is acknowledged
+  uint8_t regs[256];   //Register file, the first head byte sets the pointer
+  uint8_t pointer;
+  uint32_t transfers;  //Transfers attempted
+  uint32_t bytesWritten;
+  uint32_t bytesRead;
+private:
+  uint8_t failures;
+  uint8_t failError;
+};
+
+#endif